@@ -0,0 +1,89 @@
+#include "../include/source/source_manager.hpp"
+#include "../include/optimizer/optimizer.hpp"
+#include "../include/semantic/semantic.hpp"
+#include "../include/parser/parser.hpp"
+#include "../include/lexer/lexer.hpp"
+#include <sys/resource.h>
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+#include <string>
+
+// Front-end time on one source file: lexing, parsing, semantic analysis and constant folding, then the teardown of tokens and AST, best
+// of several runs each. Peak RSS is measured after the first run, so it covers the source mapping plus one set of tokens and AST.
+// Use: frontend_bench <source_name> [runs] [threads], e.g. on a corpus from `gen_corpus.py`
+
+struct FrontendTimes {
+    double lex;
+    double parse;
+    double analyze;
+    double fold;
+    double teardown;
+};
+
+static FrontendTimes run_frontend(std::uint32_t file_id, unsigned threads_count) {
+    FrontendTimes times{};
+    auto start = std::chrono::steady_clock::now();
+    auto lap = [&start]() {
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - start).count();
+        start = now;
+        return seconds;
+    };
+    {
+        Lexer lexer(file_id);
+        std::vector<Token> tokens = lexer.tokenize();
+        times.lex = lap();
+        Arena arena;
+        Parser parser(std::move(tokens), arena);
+        std::vector<StmtPtr> stmts = parser.parse_parallel(threads_count);
+        times.parse = lap();
+        SemanticAnalyzer semantic(stmts);
+        semantic.analyze(threads_count);
+        times.analyze = lap();
+        ConstantFolder folder(arena);
+        folder.fold(stmts);
+        times.fold = lap();
+    }
+    times.teardown = lap();
+    return times;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Use: frontend_bench <source_name> [runs] [threads]\n";
+        return 1;
+    }
+    int runs = argc > 2 ? std::max(1, std::stoi(argv[2])) : 3;
+    unsigned threads_count = argc > 3 ? std::max(1, std::stoi(argv[3])) : 1;
+    std::optional<std::uint32_t> file_id = SourceManager::load_file(argv[1]);
+    if (!file_id) {
+        std::cerr << "Error opening file!\n";
+        return 1;
+    }
+
+    FrontendTimes best{};
+    long peak_rss_kb = 0;
+    for (int run = 0; run < runs; run++) {
+        FrontendTimes times = run_frontend(*file_id, threads_count);
+        if (run == 0) {
+            rusage usage{};
+            getrusage(RUSAGE_SELF, &usage);
+            peak_rss_kb = usage.ru_maxrss;
+            best = times;
+        }
+        best.lex = std::min(best.lex, times.lex);
+        best.parse = std::min(best.parse, times.parse);
+        best.analyze = std::min(best.analyze, times.analyze);
+        best.fold = std::min(best.fold, times.fold);
+        best.teardown = std::min(best.teardown, times.teardown);
+    }
+
+    std::size_t source_bytes = SourceManager::get_content(*file_id).size();
+    std::cout << "source:         " << source_bytes << " bytes, " << threads_count << " threads\n"
+              << "best of " << runs << " (ms):  lex " << best.lex * 1000 << ", parse " << best.parse * 1000 << ", analyze " << best.analyze * 1000
+              << ", fold " << best.fold * 1000 << ", teardown " << best.teardown * 1000 << '\n'
+              << "front end:      " << (best.lex + best.parse + best.analyze + best.fold) * 1000 << " ms\n"
+              << "peak RSS:       " << peak_rss_kb / 1024 << " MB\n";
+    return 0;
+}
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Generates a large Blink source for the lexer and compiler benchmarks: functions with declarations, loops, conditions, calls,
+comments and string literals, in the proportions of hand-written code"""
+import argparse
+import random
+
+TYPES = ["i8", "i16", "i32", "i64", "u8", "u16", "u32", "u64", "f32", "f64", "bool"]
+
+
+def value(rng, type_name):
+    if type_name == "bool":
+        return rng.choice(["true", "false"])
+    if type_name.startswith("f"):
+        return "%d.%d" % (rng.randint(0, 1000), rng.randint(0, 99))
+    return str(rng.randint(0, 100))
+
+
+def function(rng, index):
+    lines = ["/* function %d: generated for benchmarking," % index, "   only the first one is called */"]
+    lines.append("func function_%d(first_argument: i32, second_argument: i64) : i32 {" % index)
+    names = []
+    for local in range(rng.randint(4, 10)):
+        type_name = rng.choice(TYPES)
+        name = "local_variable_%d" % local
+        lines.append("    var %s: %s = %s; // local %d" % (name, type_name, value(rng, type_name), local))
+        if type_name.startswith("i"):
+            names.append(name)
+    names = names or ["first_argument"]
+    lines.append("    var accumulator: i32 = 0;")
+    lines.append("    for (counter: i32 = 0; counter < first_argument; counter += 1) {")
+    lines.append("        if (counter % 3 == 0 && accumulator < 1000000) {")
+    lines.append("            accumulator += counter * %d + %s;" % (rng.randint(1, 9), rng.choice(names)))
+    lines.append("        } else {")
+    lines.append("            accumulator -= (counter << 1) ^ 0x%X;" % rng.randint(0, 0xFFFF))
+    lines.append("        }")
+    lines.append("    }")
+    lines.append("    while (accumulator > 100) {")
+    lines.append("        accumulator = accumulator / 2;")
+    lines.append("    }")
+    lines.append('    printf("function_%d: %%d, %%s\\n", accumulator, "done");' % index)
+    lines.append("    return accumulator;")
+    lines.append("}")
+    lines.append("")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("output")
+    parser.add_argument("--functions", type=int, default=40000, help="number of generated functions (40000 is about 30 MB)")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    with open(args.output, "w") as output:
+        for index in range(args.functions):
+            output.write("\n".join(function(rng, index)))
+            output.write("\n")
+        output.write("func main() : i32 {\n    printf(\"%d\\n\", function_0(10, 20));\n    return 0;\n}\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,44 @@
+#include "../include/source/source_manager.hpp"
+#include "../include/lexer/scanner.hpp"
+#include "../include/lexer/lexer.hpp"
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+#include <string>
+
+// Lexer throughput on one source file: tokens/s, MB/s and memory per token, best of several runs.
+// Use: lexer_bench <source_name> [runs], e.g. on a corpus from `gen_corpus.py`
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Use: lexer_bench <source_name> [runs]\n";
+        return 1;
+    }
+    int runs = argc > 2 ? std::max(1, std::stoi(argv[2])) : 5;
+    std::optional<std::uint32_t> file_id = SourceManager::load_file(argv[1]);
+    if (!file_id) {
+        std::cerr << "Error opening file!\n";
+        return 1;
+    }
+
+    std::size_t source_bytes = SourceManager::get_content(*file_id).size();
+    std::size_t tokens_count = 0;
+    double best_seconds = 0;
+    for (int run = 0; run < runs; run++) {
+        Lexer lexer(*file_id);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Token> tokens = lexer.tokenize();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        tokens_count = tokens.size();
+        if (run == 0 || seconds < best_seconds) {
+            best_seconds = seconds;
+        }
+    }
+
+    std::cout << "scanner:        " << get_scanner_isa_name() << '\n'
+              << "source:         " << source_bytes << " bytes, " << tokens_count << " tokens\n"
+              << "token size:     " << sizeof(Token) << " bytes, no heap allocations\n"
+              << "source/token:   " << static_cast<double>(source_bytes) / tokens_count << " bytes\n"
+              << "best of " << runs << ":      " << best_seconds * 1000 << " ms, " << tokens_count / best_seconds / 1e6 << " M tokens/s, "
+              << source_bytes / best_seconds / 1e6 << " MB/s\n";
+    return 0;
+}
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Compiles the numeric kernels of bench/kernels and the loops of examples/ with `blinkc` at every optimization level and prints the
+best of several run times of each executable, with the speedup over -O0. Every level has to print what the -O0 build prints"""
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+EXAMPLES_DIR = os.path.join(os.path.dirname(BENCH_DIR), "examples")
+KERNELS_DIR = os.path.join(BENCH_DIR, "kernels")
+EXAMPLE_LOOPS = ["stack_loop.bl"]       # the other examples run a few iterations, too few to time
+LEVELS = ["-O0", "-O1", "-O2", "-O3", "-Os", "-Oz"]
+
+
+def default_sources():
+    kernels = sorted(os.path.join(KERNELS_DIR, name) for name in os.listdir(KERNELS_DIR) if name.endswith(".bl"))
+    return kernels + [os.path.join(EXAMPLES_DIR, name) for name in EXAMPLE_LOOPS]
+
+
+# `blinkc` puts the executable next to the source, so every build compiles a copy in `work_dir`
+def build(blinkc, flags, level, source, work_dir):
+    source_copy = os.path.join(work_dir, os.path.basename(source))
+    shutil.copyfile(source, source_copy)
+    result = subprocess.run([blinkc, level] + flags + [source_copy], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if result.returncode != 0:
+        sys.exit("%s %s does not compile:\n%s" % (level, source, result.stdout))
+    return os.path.splitext(source_copy)[0]
+
+
+def best_run(executable, runs):
+    best_seconds = None
+    output = None
+    for run in range(runs):
+        start = time.perf_counter()
+        result = subprocess.run([executable], stdout=subprocess.PIPE, text=True)
+        seconds = time.perf_counter() - start
+        if result.returncode != 0:
+            sys.exit("%s exits with %d" % (executable, result.returncode))
+        output = result.stdout
+        best_seconds = seconds if best_seconds is None else min(best_seconds, seconds)
+    return best_seconds, output
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("blinkc")
+    parser.add_argument("sources", nargs="*", help="programs to measure (the kernels and the example loops by default)")
+    parser.add_argument("--levels", default=" ".join(LEVELS), help="optimization levels, separated by spaces")
+    parser.add_argument("--flags", default="", help="other `blinkc` options, e.g. -march=native")
+    parser.add_argument("--runs", type=int, default=3, help="runs of every executable, the best one counts")
+    args = parser.parse_args()
+
+    blinkc = os.path.abspath(args.blinkc)
+    levels = args.levels.split()
+    flags = args.flags.split()
+    sources = args.sources or default_sources()
+
+    print("%-16s" % "program" + "".join("%20s" % level for level in levels))
+    with tempfile.TemporaryDirectory() as work_dir:
+        for source in sources:
+            row = "%-16s" % os.path.basename(source)
+            base_seconds = None
+            base_output = None
+            for level in levels:
+                seconds, output = best_run(build(blinkc, flags, level, source, work_dir), args.runs)
+                if base_seconds is None:
+                    base_seconds, base_output = seconds, output
+                elif output != base_output:
+                    sys.exit("%s %s prints %r instead of %r" % (level, source, output, base_output))
+                row += "%20s" % ("%.1f ms (%.1fx)" % (seconds * 1000, base_seconds / seconds))
+            print(row, flush=True)
+
+
+if __name__ == "__main__":
+    main()
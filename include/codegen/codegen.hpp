@@ -1,5 +1,9 @@
 #pragma once
 #include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/ValueHandle.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Function.h>
@@ -9,7 +13,14 @@
 
 #include "../parser/ast.hpp"
 #include <stack>
-#include <map>
+#include <vector>
+
+// Targets of `break` and `continue` in a loop, and how many scoped locals were live when its body was entered
+struct LoopTargets {
+    llvm::BasicBlock* break_bb;
+    llvm::BasicBlock* continue_bb;
+    std::size_t locals_mark;
+};
 
 class CodeGenerator {
 private:
@@ -18,24 +29,69 @@ private:
     std::unique_ptr<llvm::Module> module;
     std::vector<StmtPtr>& stmts;
     unsigned blocks_deep;
-    std::stack<std::map<std::string, llvm::Value*>> variables;
-    std::map<std::string, llvm::Function*> functions;
-    std::stack<std::pair<llvm::BasicBlock*, llvm::BasicBlock*>> loop_blocks;    // first for `break`, second for `continue`
+    std::vector<llvm::Value*> variables;        // indexed by the declaration slots assigned by `SemanticAnalyzer`, `nullptr` for SSA locals
+    std::vector<llvm::Function*> functions;
+    std::stack<LoopTargets> loop_blocks;
+    // All locals are allocated in the entry block of the function, after `last_alloca`. Locals of nested blocks are also recorded in
+    // `scoped_locals`, so their lifetime can be ended when the block is left; `scope_marks` holds the size it had at each block start
+    llvm::AllocaInst* last_alloca;
+    std::vector<llvm::AllocaInst*> scoped_locals;
+    std::vector<std::size_t> scope_marks;
+
+    // With `direct_ssa` locals get no stack slots: their values are tracked per block and phi nodes are placed on the fly (Braun et al.,
+    // "Simple and Efficient Construction of Static Single Assignment Form"). A block is sealed once all of its predecessors are known,
+    // until then reads in it go through placeholder phis listed in `incomplete_phis`. Definitions are tracked by value handles, so they
+    // follow the replacement of trivial phis
+    bool direct_ssa;
+    std::vector<std::pair<llvm::Type*, std::string_view>> ssa_locals;      // type and name of every local, indexed by its slot
+    llvm::DenseMap<std::pair<llvm::BasicBlock*, std::uint32_t>, llvm::WeakTrackingVH> current_defs;
+    llvm::DenseSet<llvm::BasicBlock*> sealed_blocks;
+    llvm::DenseMap<llvm::BasicBlock*, std::vector<std::pair<std::uint32_t, llvm::PHINode*>>> incomplete_phis;
+    std::string target_cpu;         // `target-cpu` and `target-features` attributes of every generated function, none if empty
+    std::string target_features;
+
+    // Expressions `generate_expr` has reached, `stage` counts the operands pushed above them. `&&` and `||` in functions keep the blocks
+    // they branch between. Values of generated operands are on `operand_values`
+    struct PendingExpr {
+        const Expr* expr;
+        unsigned char stage;
+        llvm::BasicBlock* right_bb;
+        llvm::BasicBlock* end_bb;
+        llvm::BasicBlock* left_end_bb;
+    };
+    std::vector<PendingExpr> pending_exprs;
+    std::vector<llvm::Value*> operand_values;
 
 public:
     CodeGenerator(std::string n, std::vector<StmtPtr>& s) : context(), builder(context), module(std::make_unique<llvm::Module>(n, context)),
-                                                            stmts(s), blocks_deep(0) {
-        variables.push({});
-    }
+                                                            stmts(s), blocks_deep(0), last_alloca(nullptr), direct_ssa(false) {}
 
+    void set_target(std::string cpu, std::string features);
+    void set_direct_ssa(bool enabled);
     void generate();
+    void generate_builtins();
+    void generate_stmt(const Stmt& stmt);
     std::unique_ptr<llvm::Module> get_module();
     void print_ir() const;
 
 private:
-    llvm::Type* get_llvm_type(Type type, Token first_token);
+    llvm::Type* get_llvm_type(TypeId type, SourceLocation location);
+    void bind_variable(std::uint32_t variable_id, llvm::Value* value);
+    void bind_function(std::uint32_t function_id, llvm::Function* function);
+    llvm::Function* declare_function(const FuncDeclStmt& fds);
+    llvm::AllocaInst* create_local(llvm::Type* type, std::string_view name);
+    void push_scope();
+    void pop_scope();
+    void end_lifetimes(std::size_t mark);
+
+    void declare_ssa_local(std::uint32_t variable_id, llvm::Type* type, std::string_view name, llvm::Value* value);
+    void write_local(std::uint32_t variable_id, llvm::BasicBlock* block, llvm::Value* value);
+    llvm::Value* read_local(std::uint32_t variable_id, llvm::BasicBlock* block);
+    llvm::Value* read_local_recursive(std::uint32_t variable_id, llvm::BasicBlock* block);
+    llvm::Value* add_phi_operands(std::uint32_t variable_id, llvm::PHINode* phi);
+    llvm::Value* remove_trivial_phi(llvm::PHINode* phi);
+    void seal_block(llvm::BasicBlock* block);
 
-    void generate_stmt(const Stmt& stmt);
     void generate_var_decl_stmt(const VarDeclStmt& vds);
     void generate_func_decl_stmt(const FuncDeclStmt& fds);
     void generate_func_call_stmt(const FuncCallStmt& fcs);
@@ -48,11 +104,14 @@ private:
     void generate_continue_stmt();
     void generate_return_stmt(const ReturnStmt& rs);
 
-    llvm::Value* generate_expr(const Expr& expr);
+    llvm::Value* generate_expr(const Expr& root);
     llvm::Value* generate_literal(const Literal& lit);
-    llvm::Value* generate_binary_expr(const BinaryExpr& be);
-    llvm::Value* generate_unary_expr(const UnaryExpr& ue);
+    llvm::Value* generate_binary_expr(const BinaryExpr& be, llvm::Value* left, llvm::Value* right);
+    llvm::Value* generate_logical_expr(std::size_t index);
+    void generate_cond_br(const Expr& condition, llvm::BasicBlock* true_bb, llvm::BasicBlock* false_bb);
+    llvm::Value* generate_unary_expr(const UnaryExpr& ue, llvm::Value* value);
     llvm::Value* generate_var_expr(const VarExpr& ve);
     llvm::Value* generate_func_call_expr(const FuncCallExpr& fce);
-    llvm::Value* implicitly_cast(llvm::Value* value, llvm::Type* expected_type, Token first_token);
+    bool is_unsigned_int(const TypeInfo& info) const;
+    llvm::Value* convert(llvm::Value* value, TypeId from, TypeId to, SourceLocation location);
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include "../source/source_location.hpp"
 #include <cstdint>
 #include <string>
 
@@ -9,4 +10,24 @@ enum SubsystemType {
     CODEGEN,
 };
 
-void throw_error(std::string file_name, SubsystemType subsystem_type, std::string message, int line, std::uint8_t error_code = 1);
\ No newline at end of file
+// Error raised by `throw_error` while errors are deferred on the current thread
+struct CompileError {
+    SourceLocation location;
+    SubsystemType subsystem_type;
+    std::string message;
+    std::uint8_t error_code;
+};
+
+// While alive, `throw_error` on this thread throws `CompileError` instead of printing the error and exiting.
+// Worker threads use it so that the driver can report errors in source order after joining them
+class DeferredErrorsScope {
+private:
+    bool previous;
+
+public:
+    DeferredErrorsScope();
+    ~DeferredErrorsScope();
+};
+
+void throw_error(SourceLocation location, SubsystemType subsystem_type, std::string message, std::uint8_t error_code = 1);
+void report_error(const CompileError& error);
\ No newline at end of file
@@ -1,24 +1,24 @@
 #pragma once
 #include "token.hpp"
+#include <string_view>
+#include <memory>
 #include <string>
 #include <vector>
 
 class Lexer {
 private:
-    std::string source;
+    std::string_view source;
     unsigned long source_len;
-    int pos;
-    int line;
-    int column;
-    std::vector<Token> tokens;
-    std::string file_name;
+    std::size_t pos;
+    std::uint32_t file_id;
+    SourceLocation base_location;
+    std::unique_ptr<Lexer> include_lexer;    // lexer of the `$include`d file currently being read, its tokens come first
 
 public:
-    static std::vector<std::string> included_files_paths;
-
-    Lexer(std::string s, std::string fn) : source(s), source_len(s.length()), pos(0), line(1), column(1), file_name(fn), tokens({}) {}
+    Lexer(std::uint32_t fid);
 
     std::vector<Token> tokenize();
+    Token next_token();
 
 private:
     Token tokenize_number();
@@ -29,10 +29,16 @@ private:
 
     void skip_singleline_comment();
     void skip_multiline_comment();
+    void skip_quoted(char quote, SourceLocation start_location);
     void handle_preprocessor();
     void handle_preprocessor_include();
 
-    const char advance_escape_sequence();
+    void skip_escape_sequence();
     const char peek(int rpos = 0);
     const char advance();
+    void advance_to(unsigned long new_pos);
+    SourceLocation get_location() const;
 };
+
+bool get_escape_sequence_value(char c, char& value);
+std::string unescape_string(std::string_view raw);
@@ -0,0 +1,12 @@
+#pragma once
+
+// Bulk scanning kernels used by the lexer. The input must be followed by `SOURCE_PADDING` zero bytes: every kernel also stops at '\0',
+// so a scan never runs past the padded end of the buffer. SSE2/AVX2 versions are selected at runtime, with a scalar fallback.
+// `BLINK_SCANNER=scalar|sse2|avx2` in the environment forces a version, e.g. to compare them in `lexer_bench`
+const char* scan_identifier(const char* p);                 // first byte that is not [A-Za-z0-9_]
+const char* scan_whitespace(const char* p);                 // first byte that is not ' ' or '\n'
+const char* scan_line_end(const char* p);                   // first '\n' or '\0'
+const char* scan_comment_end(const char* p);                // first '/' preceded by '*', or '\0'; reads `p[-1]`, which must be in the comment body
+const char* scan_quote(const char* p, char quote);          // first `quote`, '\\' or '\0'
+
+const char* get_scanner_isa_name();
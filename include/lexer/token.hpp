@@ -1,5 +1,8 @@
 #pragma once
-#include <string>
+#include "../source/source_location.hpp"
+#include "../source/interner.hpp"
+#include <string_view>
+#include <cstdint>
 
 enum class TokenType {
     I8,
@@ -83,16 +86,21 @@ enum class TokenType {
     STRING_LIT,
 
     ID,
+
+    END_OF_FILE,                        // returned by `Lexer::next_token` once the source is exhausted
 };
 
+// `value` views the source buffer owned by `SourceManager` (or a static string for operators), so tokens are trivially copyable.
+// Number and char literals are decoded once by the lexer into `int_value`/`float_value` according to `type`
 struct Token {
     TokenType type;
-    std::string value;
-
-    int line;
-    int column;
-
-    std::string file_name;
+    SourceLocation location;
+    std::string_view value;
+    union {
+        std::uint64_t int_value;
+        double float_value;
+        Symbol symbol;              // `ID` tokens
+    };
 
-    Token(TokenType t, std::string v, int l, int c, std::string fn) : type(t), value(v), line(l), column(c), file_name(fn) {}
+    Token(TokenType t, std::string_view v, SourceLocation loc) : type(t), location(loc), value(v), int_value(0) {}
 };
@@ -0,0 +1,17 @@
+#pragma once
+#include "../parser/ast.hpp"
+
+// Compile-time value of a number or a `bool`, its type is the type of the AST node it was computed for
+struct Constant {
+    std::uint64_t bits;     // integers are sign- or zero-extended from their width, `bool` is 0 or 1
+    double number;          // `f32` and `f64`
+};
+
+// Shared by `ConstantFolder` and `Interpreter`. Evaluation matches the LLVM instructions `CodeGenerator` emits and fails wherever those
+// would be poison (division by zero, too wide shifts, out-of-range float to integer conversions)
+bool is_foldable_type(TypeId type);
+bool read_constant(const Value& value, Constant& constant);
+Value make_constant_value(Constant constant, TypeId type);
+bool evaluate_binary(TokenType op_type, TypeId operands_type, TypeId result_type, Constant left, Constant right, Constant& result);
+bool evaluate_unary(TokenType op_type, TypeId operand_type, Constant value, Constant& result);
+bool evaluate_conversion(Constant value, TypeId from, TypeId to, Constant& result);
@@ -0,0 +1,56 @@
+#pragma once
+#include "constant.hpp"
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Runs calls of pure functions at compile time for `ConstantFolder`. A function counts as pure if it only reads its arguments, its locals
+// and `const` globals with known values, only writes its locals and only calls pure functions; anything else (`printf`, other globals,
+// strings) makes the evaluation fail and the call is left to run time. Every evaluation may take `STEPS_BUDGET` statements and expressions
+// and `MAX_CALLS_DEPTH` nested calls, so endless loops and too deep recursion are left to run time as well
+class Interpreter {
+private:
+    static constexpr unsigned long STEPS_BUDGET = 1000000;
+    static constexpr unsigned MAX_CALLS_DEPTH = 256;
+
+    enum class Flow {
+        NEXT, BREAK, CONTINUE, RETURN, FAIL
+    };
+
+    // Locals of one call as (declaration slot, value), functions have few of them
+    struct Frame {
+        std::vector<std::pair<std::uint32_t, Constant>> variables;
+        Constant return_value;
+    };
+
+    std::vector<const FuncDeclStmt*> functions;     // indexed by the function ids of `SemanticAnalyzer`
+    const std::vector<std::optional<Value>>& globals;      // values of `const` globals, indexed by their declaration slots
+    Frame* frame;
+    unsigned long steps_left;
+    unsigned calls_depth;
+
+    // Expressions `evaluate` has reached, `stage` counts the operands pushed above them. Values of evaluated operands are on `operands`
+    struct PendingExpr {
+        const Expr* expr;
+        unsigned char stage;
+    };
+    std::vector<PendingExpr> pending_exprs;
+    std::vector<Constant> operands;
+
+public:
+    Interpreter(const std::vector<std::optional<Value>>& g) : globals(g), frame(nullptr), steps_left(0), calls_depth(0) {}
+
+    void add_function(const FuncDeclStmt& fds);
+    bool call(std::uint32_t function_id, const std::vector<Constant>& args, Constant& result);
+
+private:
+    bool invoke(std::uint32_t function_id, const std::vector<Constant>& args, Constant& result);
+    Flow execute_block(ArenaSpan<StmtPtr> block);
+    Flow execute_stmt(const Stmt& stmt);
+    Flow execute_loop(const Expr* condition, ArenaSpan<StmtPtr> block, const Stmt* iteration, bool check_first);
+    bool evaluate(const Expr& root, Constant& value);
+    bool evaluate_call(std::uint32_t function_id, ArenaSpan<ExprPtr> args, Constant& result);
+
+    Constant* find_variable(std::uint32_t variable_id);
+    void set_variable(std::uint32_t variable_id, Constant value);
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include "interpreter.hpp"
+#include "constant.hpp"
+#include <optional>
+#include <vector>
+
+struct FoldStats {
+    unsigned long folded_exprs;         // expressions replaced by a literal
+    unsigned long propagated_uses;      // uses of `const` variables replaced by their value
+    unsigned long folded_branches;      // `if` statements replaced by one of their blocks
+    unsigned long comptime_calls;       // calls in `const` initializers evaluated by `Interpreter`
+    unsigned long eliminated_nodes;     // AST nodes removed from the tree
+};
+
+// AST pass run between `SemanticAnalyzer` and `CodeGenerator`. Folds arithmetic, comparisons and conversions of literals, propagates
+// `const` variables with constant initializers into their uses (dropping the declarations of such locals) and replaces `if` statements
+// with constant conditions by the taken block. Calls in `const` initializers are run by `Interpreter` when all their arguments are constant
+class ConstantFolder {
+private:
+    Arena& arena;
+    std::vector<std::optional<Value>> constants;    // values of `const` variables, indexed by the declaration slots of `SemanticAnalyzer`
+    std::vector<std::optional<Value>> globals;      // the same for globals only, as the slots of locals are shared by all functions
+    Interpreter interpreter;
+    bool in_function;
+    bool in_const_initializer;
+    bool streaming;         // statements come one at a time through `fold_stmt`, no function bodies are kept for `Interpreter`
+    FoldStats stats;
+
+    // Expression slots `fold_expr` has reached but not folded yet, `operands_done` once their operands are on the stack above them
+    struct PendingExpr {
+        ExprPtr* slot;
+        bool operands_done;
+    };
+    std::vector<PendingExpr> pending_exprs;
+
+public:
+    ConstantFolder(Arena& a) : arena(a), interpreter(globals), in_function(false), in_const_initializer(false), streaming(false), stats{} {}
+
+    void fold(std::vector<StmtPtr>& stmts);
+    void fold_globals(std::vector<StmtPtr>& stmts);
+    void set_streaming(bool enabled);
+    void fold_stmt(Stmt& stmt);
+    FoldStats get_stats() const;
+
+private:
+    void fold_block(ArenaSpan<StmtPtr>& block);
+    void fold_var_decl_stmt(VarDeclStmt& vds);
+    void fold_expr(ExprPtr& root);
+    void fold_operation(ExprPtr& expr);
+    void fold_args(ArenaSpan<ExprPtr> args);
+    ExprPtr make_literal(Constant constant, TypeId type, const Expr& replaced);
+
+    bool get_constant(const Expr& expr, Constant& constant) const;
+
+    void set_constant(std::uint32_t variable_id, std::optional<Value> value);
+    unsigned long count_nodes(const Stmt& stmt) const;
+    unsigned long count_nodes(const Expr& root) const;
+};
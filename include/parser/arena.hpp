@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <string_view>
+#include <new>
+
+// Contiguous array living in an `Arena`
+template<typename T>
+struct ArenaSpan {
+    T* data;
+    std::size_t length;
+
+    ArenaSpan() : data(nullptr), length(0) {}
+    ArenaSpan(T* d, std::size_t l) : data(d), length(l) {}
+
+    T* begin() const { return data; }
+    T* end() const { return data + length; }
+    T& operator [](std::size_t index) const { return data[index]; }
+    std::size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+};
+
+// Allocation state of an `Arena`, see `Arena::rewind`
+struct ArenaMark {
+    std::size_t chunks_count;
+    char* current;
+    std::size_t remaining;
+    std::size_t bytes_used;
+    std::size_t bytes_reserved;
+};
+
+// Bump-pointer allocator that owns the AST for the whole compilation. Destructors are never run: everything placed in the arena must be
+// trivially destructible (or own nothing outside the arena), so releasing the AST is freeing a few chunks
+class Arena {
+private:
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char* current;
+    std::size_t remaining;
+    std::size_t bytes_used;
+    std::size_t bytes_reserved;
+
+public:
+    Arena() : current(nullptr), remaining(0), bytes_used(0), bytes_reserved(0) {}
+    Arena(const Arena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    template<typename T, typename... Args>
+    T* make(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template<typename T>
+    ArenaSpan<T> copy(const std::vector<T>& items) {
+        if (items.empty()) {
+            return ArenaSpan<T>();
+        }
+        T* data = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+        std::uninitialized_copy(items.begin(), items.end(), data);
+        return ArenaSpan<T>(data, items.size());
+    }
+
+    std::string_view copy_string(std::string_view str);
+
+    // Takes over the chunks of `other` (e.g. the arena of a worker thread), which is left empty
+    void merge(Arena& other);
+
+    // Frees everything allocated after `mark` was taken (used to drop the AST of each top-level declaration in streaming mode)
+    ArenaMark get_mark() const;
+    void rewind(ArenaMark mark);
+
+    std::size_t get_bytes_used() const;
+    std::size_t get_bytes_reserved() const;
+};
@@ -1,38 +1,16 @@
 #pragma once
 #include "../lexer/token.hpp"
+#include "../types/type_context.hpp"
+#include "arena.hpp"
 #include <cstdint>
 #include <variant>
+#include <string>
 #include <vector>
-#include <memory>
 #include <cmath>
 
-enum class TypeValue {
-    BOOL, I8, I16, I32, I64, F32, F64, U8, U16, U32, U64, STRING, NOTHING, CLASS, ENUM
-};
-
-struct Type {
-    TypeValue type;
-    std::string name;
-    bool is_const;
-    bool is_unsigned;
-    bool is_pointer;
-
-    Type(TypeValue t, std::string n, bool is_c = false, bool is_u = false, bool is_p = false)
-       : type(t), name(n), is_const(is_c), is_unsigned(is_u), is_pointer(is_p) {}
-    
-    bool operator ==(Type& other) const {
-        return this->type == other.type && this->name == other.name && this->is_const == other.is_const
-            && this->is_unsigned == other.is_unsigned && this->is_pointer == other.is_pointer;
-    }
-
-    bool operator !=(Type& other) const {
-        return !(*this == other);
-    }
-};
-
 struct Value {
     std::variant<std::int8_t, std::int16_t, std::int32_t, std::int64_t, std::float_t, std::double_t, std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t,
-                 bool, std::string> value;
+                 bool, std::string_view> value;
 
     Value(std::int8_t v)        : value(v) {}
     Value(std::int16_t v)       : value(v) {}
@@ -45,105 +23,110 @@ struct Value {
     Value(std::uint32_t v)      : value(v) {}
     Value(std::uint64_t v)      : value(v) {}
     Value(bool v)               : value(v) {}
-    Value(std::string v)        : value(v) {}
+    Value(std::string_view v)   : value(v) {}
+};
+
+// Tag of every AST node. Passes dispatch on it with a single `switch` and `static_cast` to the concrete node class
+enum class NodeKind : std::uint8_t {
+    // Expressions
+    LITERAL, BINARY_EXPR, UNARY_EXPR, VAR_EXPR, FUNC_CALL_EXPR,
+    // Statements
+    VAR_DECL_STMT, FUNC_DECL_STMT, FUNC_CALL_STMT, VAR_ASGN_STMT, IF_STMT, FOR_CYCLE_STMT, WHILE_CYCLE_STMT, DO_WHILE_CYCLE_STMT,
+    BREAK_STMT, CONTINUE_STMT, RETURN_STMT
 };
 
+// All nodes live in the `Arena` of the compilation: they are never destroyed one by one, so they must not own heap memory.
+// Names are interned `Symbol`s, string literals are `std::string_view`s into the arena, child lists are `ArenaSpan`s.
+// Nodes are not polymorphic (no vtable): the concrete class is identified by `kind`
 class Expr {
 public:
-    Token first_token;
-    Expr(Token ft) : first_token(ft) {}
-    virtual ~Expr() = default;
+    NodeKind kind;
+    SourceLocation location;
+    TypeId type;                // resolved by `SemanticAnalyzer`
+    TypeId converted_type;      // type the value is converted to where it is used, `type` if it is used as is
+    Expr(NodeKind k, SourceLocation loc, TypeId t = NO_TYPE) : kind(k), location(loc), type(t), converted_type(t) {}
 };
 
 class Stmt {
 public:
-    Token first_token;
-    Stmt(Token ft) : first_token(ft) {}
-    virtual ~Stmt() = default;
+    NodeKind kind;
+    SourceLocation location;
+    Stmt(NodeKind k, SourceLocation loc) : kind(k), location(loc) {}
 };
 
-using ExprPtr = std::unique_ptr<Expr>;
-using StmtPtr = std::unique_ptr<Stmt>;
+using ExprPtr = Expr*;
+using StmtPtr = Stmt*;
+
+// Declaration slots assigned by `SemanticAnalyzer`: variables (function arguments included) and functions are numbered in declaration order,
+// and every use of a name stores the slot of its declaration, so code generation does no name lookups
+constexpr std::uint32_t NO_DECLARATION = UINT32_MAX;
+constexpr std::uint32_t PRINTF_FUNCTION_ID = 0;    // `printf` is a builtin, user functions are numbered after it
 
 class Literal : public Expr {
 public:
     Value value;
-    Type type;
 
-    Literal(Value v, Type t, Token ft) : value(v), type(t), Expr(ft) {}
-    virtual ~Literal() = default;
+    Literal(Value v, TypeId t, SourceLocation loc) : value(v), Expr(NodeKind::LITERAL, loc, t) {}
 };
 
 class I8Literal : public Literal {
 public:
-    I8Literal(std::int8_t v, Token ft) : Literal(Value(v), Type(TypeValue::I8, "i8"), ft) {}
-    ~I8Literal() override = default;
+    I8Literal(std::int8_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::I8), loc) {}
 };
 
 class I16Literal : public Literal {
 public:
-    I16Literal(std::int16_t v, Token ft) : Literal(Value(v), Type(TypeValue::I16, "i16"), ft) {}
-    ~I16Literal() override = default;
+    I16Literal(std::int16_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::I16), loc) {}
 };
 
 class I32Literal : public Literal {
 public:
-    I32Literal(std::int32_t v, Token ft) : Literal(Value(v), Type(TypeValue::I32, "i32"), ft) {}
-    ~I32Literal() override = default;
+    I32Literal(std::int32_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::I32), loc) {}
 };
 
 class I64Literal : public Literal {
 public:
-    I64Literal(std::int64_t v, Token ft) : Literal(Value(v), Type(TypeValue::I64, "i64"), ft) {}
-    ~I64Literal() override = default;
+    I64Literal(std::int64_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::I64), loc) {}
 };
 
 class F32Literal : public Literal {
 public:
-    F32Literal(std::float_t v, Token ft) : Literal(Value(v), Type(TypeValue::F32, "f32"), ft) {}
-    ~F32Literal() override = default;
+    F32Literal(std::float_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::F32), loc) {}
 };
 
 class F64Literal : public Literal {
 public:
-    F64Literal(std::double_t v, Token ft) : Literal(Value(v), Type(TypeValue::F64, "f64"), ft) {}
-    ~F64Literal() override = default;
+    F64Literal(std::double_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::F64), loc) {}
 };
 
 class U8Literal : public Literal {
 public:
-    U8Literal(std::uint8_t v, Token ft) : Literal(Value(v), Type(TypeValue::U8, "u8"), ft) {}
-    ~U8Literal() override = default;
+    U8Literal(std::uint8_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::U8), loc) {}
 };
 
 class U16Literal : public Literal {
 public:
-    U16Literal(std::uint16_t v, Token ft) : Literal(Value(v), Type(TypeValue::U16, "u16"), ft) {}
-    ~U16Literal() override = default;
+    U16Literal(std::uint16_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::U16), loc) {}
 };
 
 class U32Literal : public Literal {
 public:
-    U32Literal(std::uint32_t v, Token ft) : Literal(Value(v), Type(TypeValue::U32, "u32"), ft) {}
-    ~U32Literal() override = default;
+    U32Literal(std::uint32_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::U32), loc) {}
 };
 
 class U64Literal : public Literal {
 public:
-    U64Literal(std::uint64_t v, Token ft) : Literal(Value(v), Type(TypeValue::U64, "u64"), ft) {}
-    ~U64Literal() override = default;
+    U64Literal(std::uint64_t v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::U64), loc) {}
 };
 
 class BoolLiteral : public Literal {
 public:
-    BoolLiteral(bool v, Token ft) : Literal(Value(v), Type(TypeValue::BOOL, "bool"), ft) {}
-    ~BoolLiteral() override = default;
+    BoolLiteral(bool v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::BOOL), loc) {}
 };
 
 class StringLiteral : public Literal {
 public:
-    StringLiteral(std::string v, Token ft) : Literal(Value(v), Type(TypeValue::STRING, "string"), ft) {}
-    ~StringLiteral() override = default;
+    StringLiteral(std::string_view v, SourceLocation loc) : Literal(Value(v), TypeContext::get_builtin(TypeValue::STRING), loc) {}
 };
 
 class BinaryExpr : public Expr {
@@ -152,8 +135,7 @@ public:
     ExprPtr left;
     ExprPtr right;
 
-    BinaryExpr(TokenType o, ExprPtr l, ExprPtr r, Token ft) : op_type(o), left(std::move(l)), right(std::move(r)), Expr(ft) {}
-    ~BinaryExpr() override = default;
+    BinaryExpr(TokenType o, ExprPtr l, ExprPtr r, SourceLocation loc) : op_type(o), left(l), right(r), Expr(NodeKind::BINARY_EXPR, loc) {}
 };
 
 class UnaryExpr : public Expr {
@@ -161,88 +143,87 @@ public:
     TokenType op_type;
     ExprPtr expr;
 
-    UnaryExpr(TokenType o, ExprPtr e, Token ft) : op_type(o), expr(std::move(e)), Expr(ft) {}
-    ~UnaryExpr() override = default;
+    UnaryExpr(TokenType o, ExprPtr e, SourceLocation loc) : op_type(o), expr(e), Expr(NodeKind::UNARY_EXPR, loc) {}
 };
 
 class VarExpr : public Expr {
 public:
-    std::string name;
+    Symbol name;
+    std::uint32_t variable_id;
 
-    VarExpr(std::string n, Token ft) : name(n), Expr(ft) {}
-    ~VarExpr() override = default;
+    VarExpr(Symbol n, SourceLocation loc) : name(n), variable_id(NO_DECLARATION), Expr(NodeKind::VAR_EXPR, loc) {}
 };
 
 class FuncCallExpr : public Expr {
 public:
-    std::string name;
-    std::vector<ExprPtr> args;
+    Symbol name;
+    ArenaSpan<ExprPtr> args;
+    std::uint32_t function_id;
 
-    FuncCallExpr(std::string n, std::vector<ExprPtr> a, Token ft) : name(n), args(std::move(a)), Expr(ft) {}
+    FuncCallExpr(Symbol n, ArenaSpan<ExprPtr> a, SourceLocation loc) : name(n), args(a), function_id(NO_DECLARATION),
+                                                                                 Expr(NodeKind::FUNC_CALL_EXPR, loc) {}
 };
 
 class VarDeclStmt : public Stmt {
 public:
-    Type type;
-    std::string name;
+    TypeId type;
+    Symbol name;
     ExprPtr expr;
+    std::uint32_t variable_id;
 
-    VarDeclStmt(Type t, std::string n, ExprPtr e, Token ft) : type(t), name(n), expr(std::move(e)), Stmt(ft) {}
-    ~VarDeclStmt() override = default;
+    VarDeclStmt(TypeId t, Symbol n, ExprPtr e, SourceLocation loc) : type(t), name(n), expr(e), variable_id(NO_DECLARATION),
+                                                                             Stmt(NodeKind::VAR_DECL_STMT, loc) {}
 };
 
 struct Argument {
-    Type type;
-    std::string name;
+    TypeId type;
+    Symbol name;
     ExprPtr expr;
-    Token first_token;
+    SourceLocation location;
+    std::uint32_t variable_id;
 
-    Argument(Type t, std::string n, ExprPtr e, Token ft) : type(t), name(n), expr(std::move(e)), first_token(ft) {
-        this->first_token = ft;
-    }
-    Argument(const Argument& other) : type(other.type), name(other.name), expr(other.expr == nullptr ? nullptr : std::make_unique<Expr>(*other.expr)),
-                                      first_token(other.first_token) {}
+    Argument(TypeId t, Symbol n, ExprPtr e, SourceLocation loc) : type(t), name(n), expr(e), location(loc), variable_id(NO_DECLARATION) {}
 };
 
 class FuncDeclStmt : public Stmt {
 public:
-    Type return_type;
-    std::string name;
-    std::vector<Argument> args;
-    std::vector<StmtPtr> block;
+    TypeId return_type;
+    Symbol name;
+    ArenaSpan<Argument> args;
+    ArenaSpan<StmtPtr> block;
+    std::uint32_t function_id;
 
-    FuncDeclStmt(Type t, std::string n, std::vector<Argument> a, std::vector<StmtPtr> b, Token ft) : return_type(t), name(n), args(std::move(a)), block(std::move(b)),
-                                                                                                     Stmt(ft) {}
-    ~FuncDeclStmt() override = default;
+    FuncDeclStmt(TypeId t, Symbol n, ArenaSpan<Argument> a, ArenaSpan<StmtPtr> b, SourceLocation loc) : return_type(t), name(n), args(a), block(b),
+                                                                                                                function_id(NO_DECLARATION),
+                                                                                                                Stmt(NodeKind::FUNC_DECL_STMT, loc) {}
 };
 
 class FuncCallStmt : public Stmt {
 public:
-    std::string name;
-    std::vector<ExprPtr> args;
+    Symbol name;
+    ArenaSpan<ExprPtr> args;
+    std::uint32_t function_id;
 
-    FuncCallStmt(std::string n, std::vector<ExprPtr> a, Token ft) : name(n), args(std::move(a)), Stmt(ft) {}
-    ~FuncCallStmt() override = default;
+    FuncCallStmt(Symbol n, ArenaSpan<ExprPtr> a, SourceLocation loc) : name(n), args(a), function_id(NO_DECLARATION),
+                                                                                 Stmt(NodeKind::FUNC_CALL_STMT, loc) {}
 };
 
 class VarAsgnStmt : public Stmt {
 public:
-    std::string name;
+    Symbol name;
     ExprPtr expr;
+    std::uint32_t variable_id;
 
-    VarAsgnStmt(std::string n, ExprPtr e, Token ft) : name(n), expr(std::move(e)), Stmt(ft) {}
-    ~VarAsgnStmt() override = default;
+    VarAsgnStmt(Symbol n, ExprPtr e, SourceLocation loc) : name(n), expr(e), variable_id(NO_DECLARATION), Stmt(NodeKind::VAR_ASGN_STMT, loc) {}
 };
 
 class IfStmt : public Stmt {
 public:
     ExprPtr condition;
-    std::vector<StmtPtr> true_block;
-    std::vector<StmtPtr> false_block;
+    ArenaSpan<StmtPtr> true_block;
+    ArenaSpan<StmtPtr> false_block;
 
-    IfStmt(ExprPtr c, std::vector<StmtPtr> t, std::vector<StmtPtr> f, Token ft) : condition(std::move(c)), true_block(std::move(t)), false_block(std::move(f)),
-                                                                                  Stmt(ft) {}
-    ~IfStmt() override = default;
+    IfStmt(ExprPtr c, ArenaSpan<StmtPtr> t, ArenaSpan<StmtPtr> f, SourceLocation loc) : condition(c), true_block(t), false_block(f), Stmt(NodeKind::IF_STMT, loc) {}
 };
 
 class ForCycleStmt : public Stmt {
@@ -250,47 +231,41 @@ public:
     StmtPtr indexator;
     ExprPtr condition;
     StmtPtr iteration;
-    std::vector<StmtPtr> block;
+    ArenaSpan<StmtPtr> block;
 
-    ForCycleStmt(StmtPtr ir, ExprPtr c, StmtPtr it, std::vector<StmtPtr> b, Token ft) : indexator(std::move(ir)), condition(std::move(c)), iteration(std::move(it)),
-                                                                                     block(std::move(b)), Stmt(ft) {}
-    ~ForCycleStmt() override = default;
+    ForCycleStmt(StmtPtr ir, ExprPtr c, StmtPtr it, ArenaSpan<StmtPtr> b, SourceLocation loc) : indexator(ir), condition(c), iteration(it),
+                                                                                               block(b), Stmt(NodeKind::FOR_CYCLE_STMT, loc) {}
 };
 
 class WhileCycleStmt : public Stmt {
 public:
     ExprPtr condition;
-    std::vector<StmtPtr> block;
+    ArenaSpan<StmtPtr> block;
 
-    WhileCycleStmt(ExprPtr c, std::vector<StmtPtr> b, Token ft) : condition(std::move(c)), block(std::move(b)), Stmt(ft) {}
-    ~WhileCycleStmt() override = default;
+    WhileCycleStmt(ExprPtr c, ArenaSpan<StmtPtr> b, SourceLocation loc) : condition(c), block(b), Stmt(NodeKind::WHILE_CYCLE_STMT, loc) {}
 };
 
 class DoWhileCycleStmt : public Stmt {
 public:
     ExprPtr condition;
-    std::vector<StmtPtr> block;
+    ArenaSpan<StmtPtr> block;
 
-    DoWhileCycleStmt(ExprPtr c, std::vector<StmtPtr> b, Token ft) : condition(std::move(c)), block(std::move(b)), Stmt(ft) {}
-    ~DoWhileCycleStmt() override = default;
+    DoWhileCycleStmt(ExprPtr c, ArenaSpan<StmtPtr> b, SourceLocation loc) : condition(c), block(b), Stmt(NodeKind::DO_WHILE_CYCLE_STMT, loc) {}
 };
 
 class BreakStmt : public Stmt {
 public:
-    BreakStmt(Token ft) : Stmt(ft) {}
-    ~BreakStmt() override = default;
+    BreakStmt(SourceLocation loc) : Stmt(NodeKind::BREAK_STMT, loc) {}
 };
 
 class ContinueStmt : public Stmt {
 public:
-    ContinueStmt(Token ft) : Stmt(ft) {}
-    ~ContinueStmt() override = default;
+    ContinueStmt(SourceLocation loc) : Stmt(NodeKind::CONTINUE_STMT, loc) {}
 };
 
 class ReturnStmt : public Stmt {
 public:
     ExprPtr expr;
 
-    ReturnStmt(ExprPtr e, Token ft) : expr(std::move(e)), Stmt(ft) {}
-    ~ReturnStmt() override = default;
+    ReturnStmt(ExprPtr e, SourceLocation loc) : expr(e), Stmt(NodeKind::RETURN_STMT, loc) {}
 };
\ No newline at end of file
@@ -1,18 +1,39 @@
 #pragma once
+#include "../lexer/lexer.hpp"
 #include "../lexer/token.hpp"
 #include "ast.hpp"
 
+// Operator waiting on the `parse_expr` stack. `LPAREN` entries (precedence 0) mark an open parenthesis
+struct PendingOperator {
+    TokenType type;
+    int precedence;
+    bool is_unary;
+    SourceLocation location;
+};
+
 class Parser {
 private:
+    static constexpr int UNARY_PRECEDENCE = 11;
+    static constexpr unsigned long PARALLEL_CHUNK_TOKENS = 4096;    // minimal size of a chunk parsed by one worker
+    static constexpr unsigned long TOKEN_RING_SIZE = 8;    // power of two, the parser looks at most one token back and one ahead
+
+    // In streaming mode tokens are pulled from `lexer` into the `tokens` ring buffer, and `tokens_len` counts all tokens pulled so far
+    Lexer* lexer;
     std::vector<Token> tokens;
     unsigned long tokens_len;
     int pos;
+    Arena& arena;
 
 public:
-    Parser(std::vector<Token> t) : tokens(t), tokens_len(t.size()), pos(0) {}
+    Parser(std::vector<Token> t, Arena& a) : lexer(nullptr), tokens(std::move(t)), tokens_len(tokens.size()), pos(0), arena(a) {}
+    Parser(Lexer& l, Arena& a) : lexer(&l), tokens(TOKEN_RING_SIZE, Token(TokenType::END_OF_FILE, "", 0)), tokens_len(0), pos(0), arena(a) {}
 
     std::vector<StmtPtr> parse();
+    std::vector<StmtPtr> parse_parallel(unsigned threads_count);
+    StmtPtr parse_next();
 private:
+    std::vector<unsigned long> find_top_level_boundaries() const;
+
     StmtPtr parse_stmt();
     StmtPtr parse_var_decl_stmt();
     StmtPtr parse_func_decl_stmt();
@@ -29,23 +50,17 @@ private:
     Argument parse_argument();
 
     ExprPtr parse_expr();
-    ExprPtr parse_l_and();
-    ExprPtr parse_l_or();
-    ExprPtr parse_equality();
-    ExprPtr parse_comparation();
-    ExprPtr parse_additive();
-    ExprPtr parse_multiplicative();
-    ExprPtr parse_unary();
     ExprPtr parse_primary();
 
     bool is_compound_assignment_operator(TokenType type) const;
-    ExprPtr create_compound_assignment_operator(std::string id);
+    ExprPtr create_compound_assignment_operator(Symbol id);
+    int get_binary_precedence(TokenType type) const;
     bool is_type(TokenType type) const;
-    bool is_unsigned_type(TokenType type) const;
     TypeValue token_type_to_type_value(Token token);
-    Type consume_type(bool is_const = false);
+    TypeId consume_type(bool is_const = false);
     
-    Token peek(int rpos = 0) const;
-    Token consume(TokenType type, std::string err_msg, int line, int column);
+    bool is_at_end();
+    Token peek(int rpos = 0);
+    Token consume(TokenType type, std::string err_msg);
     bool match(TokenType type);
 };
\ No newline at end of file
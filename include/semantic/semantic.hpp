@@ -1,32 +1,71 @@
 #include "../../include/parser/ast.hpp"
+#include "symbol_table.hpp"
+#include <unordered_map>
 #include <stack>
-#include <map>
 
 class SemanticAnalyzer {
 private:
     std::vector<StmtPtr>& stmts;
-    std::stack<std::map<std::string, Type>> variables;
+    struct VariableInfo {
+        TypeId type;
+        std::uint32_t id;
+        bool is_constant;       // `const` global with an initializer, its value is known at compile time
+    };
+    ScopedSymbolTable<VariableInfo> variables;
+    std::uint32_t variables_count;
     unsigned blocks_deep;
     unsigned loops_blocks_deep;
     
     struct FunctionInfo {
-        Type return_type;
+        TypeId return_type;
         std::vector<Argument> args;
+        std::uint32_t id;
 
-        FunctionInfo(Type rt, std::vector<Argument> a) : return_type(rt), args(std::move(a)) {}
+        FunctionInfo(TypeId rt, std::vector<Argument> a, std::uint32_t i) : return_type(rt), args(std::move(a)), id(i) {}
     };
-    std::map<std::string, FunctionInfo> functions;
-    std::stack<Type> functions_types_stack;
+    // Signatures are collected by the analyzer that owns `stmts`; workers checking function bodies only read them through `functions`
+    std::unordered_map<Symbol, FunctionInfo> declared_functions;
+    const std::unordered_map<Symbol, FunctionInfo>* functions;
+    std::uint32_t functions_count;
+    Symbol printf_symbol;
+    bool streaming;         // statements come one at a time through `analyze_stmt`, later declarations are not known yet
+    std::stack<TypeId> functions_types_stack;
+
+    // Call graph for `prune_unreachable_functions`: callees of every function body (indexed by function id) and of the top-level
+    // statements. `called_functions` collects the calls of whatever is being analyzed
+    std::vector<std::vector<std::uint32_t>> callees;
+    std::vector<std::uint32_t> top_level_callees;
+    std::vector<std::uint32_t> called_functions;
+
+    // Expressions `analyze_expr` has reached but not analyzed yet, `operands_done` once their operands are on the stack above them
+    struct PendingExpr {
+        Expr* expr;
+        bool operands_done;
+    };
+    std::vector<PendingExpr> pending_exprs;
 
 public:
-    SemanticAnalyzer(std::vector<StmtPtr>& s) : stmts(s), blocks_deep(0) {
-        variables.push({});
+    SemanticAnalyzer(std::vector<StmtPtr>& s) : stmts(s), variables_count(0), blocks_deep(0), loops_blocks_deep(0), functions(&declared_functions),
+                                                    functions_count(PRINTF_FUNCTION_ID + 1), printf_symbol(Interner::intern("printf")), streaming(false) {
+        variables.push_scope();
     }
+    SemanticAnalyzer(const SemanticAnalyzer&) = delete;
 
-    void analyze();
+    void analyze(unsigned threads_count = 1);
+    void set_streaming(bool enabled);
+    void analyze_stmt(Stmt& stmt);
+    bool has_function(Symbol name) const;
+    std::vector<Symbol> prune_unreachable_functions(const std::vector<Symbol>& roots);
 
 private:
-    void analyze_stmt(Stmt& stmt);
+    // Worker checking function bodies against the globals and signatures collected by `owner`
+    SemanticAnalyzer(const SemanticAnalyzer* owner) : stmts(owner->stmts), variables(owner->variables), variables_count(owner->variables_count),
+                                                      blocks_deep(0), loops_blocks_deep(0), functions(&owner->declared_functions),
+                                                      functions_count(owner->functions_count), printf_symbol(owner->printf_symbol), streaming(false) {}
+
+    void declare_function(FuncDeclStmt& fds);
+    void analyze_func_body(FuncDeclStmt& fds);
+
     void analyze_var_decl_stmt(VarDeclStmt& vds);
     void analyze_func_decl_stmt(FuncDeclStmt& fds);
     void analyze_func_call_stmt(FuncCallStmt& fcs);
@@ -39,13 +78,18 @@ private:
     void analyze_continue_stmt(ContinueStmt& cs);
     void analyze_return_stmt(ReturnStmt& rs);
 
-    Type analyze_expr(const Expr& expr);
-    Type analyze_literal(const Literal& lit);
-    Type analyze_binary_expr(const BinaryExpr& be);
-    Type analyze_unary_expr(const UnaryExpr& ue);
-    Type analyze_var_expr(const VarExpr& ve);
-    Type analyze_func_call_expr(const FuncCallExpr& fce);
+    TypeId analyze_expr(Expr& expr);
+    TypeId analyze_literal(Literal& lit);
+    TypeId analyze_binary_expr(BinaryExpr& be);
+    TypeId analyze_unary_expr(UnaryExpr& ue);
+    TypeId analyze_var_expr(VarExpr& ve);
+    TypeId analyze_func_call_expr(FuncCallExpr& fce);
+
+    TypeId analyze_call(Symbol name, ArenaSpan<ExprPtr> args, std::uint32_t& function_id, SourceLocation location);
+    void analyze_condition(Expr& condition);
+    bool is_constant_initializer(const Expr& expr, bool allows_calls);
 
-    Type get_common_type(Type left_type, Type right_type, Token first_token);
-    std::string type_to_string(Type type);
+    void convert(Expr& expr, TypeId type, SourceLocation location);
+    void promote_vararg(Expr& expr);
+    TypeId get_common_type(TypeId left_type, TypeId right_type, SourceLocation location);
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+#include "../source/interner.hpp"
+#include <cstdint>
+#include <vector>
+
+// `Symbol` -> `T` table for nested scopes. An open-addressing table maps every name ever declared to its innermost live declaration;
+// declarations are kept in `entries`, each linking to the declaration it shadows, and `entries` doubles as the undo log of the scopes.
+// Lookup and declaration are O(1), leaving a scope is O(declarations made in it), and nothing is copied on lookup
+template<typename T>
+class ScopedSymbolTable {
+private:
+    static constexpr std::uint32_t EMPTY_SLOT = UINT32_MAX;       // slot was never used
+    static constexpr std::uint32_t NO_ENTRY = UINT32_MAX - 1;     // name is known, but not declared in any live scope
+
+    struct Slot {
+        Symbol name;
+        std::uint32_t entry;
+    };
+
+    struct Entry {
+        Symbol name;
+        T value;
+        std::uint32_t shadowed;
+    };
+
+    std::vector<Slot> slots;
+    std::uint32_t slots_used;
+    std::vector<Entry> entries;
+    std::vector<std::uint32_t> scope_marks;
+
+public:
+    ScopedSymbolTable() : slots(64, Slot{ 0, EMPTY_SLOT }), slots_used(0) {}
+
+    void push_scope() {
+        scope_marks.push_back(entries.size());
+    }
+
+    void pop_scope() {
+        std::uint32_t mark = scope_marks.back();
+        scope_marks.pop_back();
+        while (entries.size() > mark) {
+            Entry& entry = entries.back();
+            slots[find_slot(entry.name)].entry = entry.shadowed;
+            entries.pop_back();
+        }
+    }
+
+    void declare(Symbol name, T value) {
+        if ((slots_used + 1) * 2 > slots.size()) {
+            grow();
+        }
+        std::uint32_t index = find_slot(name);
+        Slot& slot = slots[index];
+        if (slot.entry == EMPTY_SLOT) {
+            slot.name = name;
+            slot.entry = NO_ENTRY;
+            slots_used++;
+        }
+        entries.push_back(Entry{ name, value, slot.entry });
+        slot.entry = entries.size() - 1;
+    }
+
+    // Innermost declaration of `name`, `nullptr` if there is none
+    T* lookup(Symbol name) {
+        std::uint32_t entry = slots[find_slot(name)].entry;
+        if (entry == EMPTY_SLOT || entry == NO_ENTRY) {
+            return nullptr;
+        }
+        return &entries[entry].value;
+    }
+
+private:
+    std::uint32_t find_slot(Symbol name) const {
+        std::uint32_t mask = slots.size() - 1;
+        std::uint32_t index = (name * 0x9E3779B1u) & mask;    // symbols are dense ids: multiplying by an odd constant permutes them
+        while (slots[index].entry != EMPTY_SLOT && slots[index].name != name) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void grow() {
+        std::vector<Slot> old_slots = std::move(slots);
+        slots.assign(old_slots.size() * 2, Slot{ 0, EMPTY_SLOT });
+        for (const Slot& slot : old_slots) {
+            if (slot.entry != EMPTY_SLOT) {
+                slots[find_slot(slot.name)] = slot;
+            }
+        }
+    }
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <string_view>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+
+// Interned identifier, the same spelling always gets the same `Symbol`
+using Symbol = std::uint32_t;
+
+struct InternerStats {
+    std::size_t unique_symbols;
+    std::size_t unique_bytes;
+    std::size_t references;
+    std::size_t referenced_bytes;
+};
+
+// Hands out dense 32-bit `Symbol`s for identifiers at lex time, later stages compare and key on `Symbol`s only.
+// Spellings are `std::string_view`s into the buffers owned by `SourceManager` (or static strings), so nothing is copied.
+// Open-addressing table of `Symbol + 1` (0 is an empty slot) with the hash of every name kept aside to skip most string compares. Thread-safe
+class Interner {
+private:
+    static std::vector<std::uint32_t> slots;
+    static std::vector<std::string_view> names;
+    static std::vector<std::uint32_t> hashes;
+    static std::size_t references;
+    static std::size_t referenced_bytes;
+    static std::mutex mutex;
+
+    static void grow();
+
+public:
+    static Symbol intern(std::string_view name);
+    static std::string_view get_name(Symbol symbol);
+    static InternerStats get_stats();
+};
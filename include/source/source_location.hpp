@@ -0,0 +1,5 @@
+#pragma once
+#include <cstdint>
+
+// Offset into the global address space shared by all loaded files (see `SourceManager`). Line and column are only computed for diagnostics
+using SourceLocation = std::uint32_t;
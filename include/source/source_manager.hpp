@@ -0,0 +1,57 @@
+#pragma once
+#include "source_location.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <mutex>
+
+// Every source buffer is followed by at least `SOURCE_PADDING` zero bytes, so scanners may read past the end without bounds checks
+constexpr std::size_t SOURCE_PADDING = 64;
+
+struct SourceFile {
+    std::string path;
+    const char* data;
+    std::size_t size;
+    bool is_mapped;                 // mapped files span `size + SOURCE_PADDING` bytes, the padding being zeroed anonymous memory
+    std::vector<char> buffer;       // owns the text when the file could not be mapped
+    SourceLocation base;
+    std::vector<std::uint32_t> line_starts;     // built on the first diagnostic in this file
+
+    SourceFile(std::string p, const char* d, std::size_t s, SourceLocation bs) : path(std::move(p)), data(d), size(s), is_mapped(true), base(bs) {}
+    SourceFile(std::string p, std::vector<char> b, std::size_t s, SourceLocation bs) : path(std::move(p)), data(nullptr), size(s), is_mapped(false),
+                                                                                    buffer(std::move(b)), base(bs) {
+        data = buffer.data();
+    }
+    SourceFile(const SourceFile&) = delete;
+    ~SourceFile();
+};
+
+struct ResolvedLocation {
+    std::uint32_t file_id;
+    unsigned line;
+    unsigned column;
+};
+
+// Owns every loaded source file for the whole compilation. Regular files are memory-mapped read-only, pipes and devices (e.g. `/dev/stdin`)
+// are read into a padded buffer. Tokens keep `std::string_view`s into the text, so entries are never moved or removed.
+// Each file occupies the range [base, base + size] of one 32-bit `SourceLocation` space
+class SourceManager {
+private:
+    static std::deque<SourceFile> files;
+    static SourceLocation next_base;
+    static std::mutex line_starts_mutex;
+
+    static std::optional<SourceLocation> reserve_locations(std::size_t size);
+
+public:
+    static std::optional<std::uint32_t> load_file(const std::string& path);
+    static std::optional<std::uint32_t> find_file(const std::string& path);
+
+    static const std::string& get_path(std::uint32_t file_id);
+    static std::string_view get_content(std::uint32_t file_id);
+    static SourceLocation get_base(std::uint32_t file_id);
+    static ResolvedLocation resolve(SourceLocation location);
+};
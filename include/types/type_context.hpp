@@ -0,0 +1,53 @@
+#pragma once
+#include "../source/interner.hpp"
+#include <unordered_map>
+#include <cstdint>
+#include <string>
+#include <deque>
+#include <mutex>
+
+enum class TypeValue : std::uint8_t {
+    BOOL, I8, I16, I32, I64, F32, F64, U8, U16, U32, U64, STRING, NOTHING, CLASS, ENUM
+};
+
+constexpr std::size_t TYPE_VALUES_COUNT = static_cast<std::size_t>(TypeValue::ENUM) + 1;
+
+// Interned type, two types are equal iff their `TypeId`s are equal
+using TypeId = std::uint32_t;
+constexpr TypeId NO_TYPE = UINT32_MAX;
+
+struct TypeInfo {
+    TypeValue base;
+    bool is_const;
+    std::uint8_t pointer_depth;
+    Symbol name;                    // `CLASS` and `ENUM` types only
+
+    bool is_unsigned() const {
+        return base >= TypeValue::U8 && base <= TypeValue::U64;
+    }
+
+    bool is_float() const {
+        return pointer_depth == 0 && (base == TypeValue::F32 || base == TypeValue::F64);
+    }
+};
+
+// Creates every distinct type (base, const, pointer depth, name) once and hands out its `TypeId`. Plain builtin types (not const, not
+// pointers) are created up front with `TypeId` equal to their `TypeValue`, so `get_builtin` needs no lookup.
+// `get` is thread-safe (parser workers create types); `get_info` does not lock, types are read once parsing is done
+class TypeContext {
+private:
+    static std::deque<TypeInfo> types;
+    static std::unordered_map<std::uint64_t, TypeId> ids;
+    static std::mutex mutex;
+
+public:
+    static constexpr TypeId get_builtin(TypeValue base) {
+        return static_cast<TypeId>(base);
+    }
+    static TypeId get(TypeValue base, bool is_const = false, unsigned pointer_depth = 0, Symbol name = 0);
+    static const TypeInfo& get_info(TypeId type);
+
+    // Type both operands are converted to, `NO_TYPE` if there is none. Looked up in a precomputed promotion table
+    static TypeId get_common_type(TypeId left, TypeId right);
+    static std::string to_string(TypeId type);
+};
@@ -12,27 +12,55 @@
 #include <llvm/IR/Constant.h>
 #include <llvm/IR/Function.h>
 #include <llvm/ADT/Twine.h>
+#include <llvm/IR/CFG.h>
 #include <llvm/ADT/APInt.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
 #include <llvm/IR/Type.h>
 
+#include "../../include/source/source_manager.hpp"
 #include "../../include/exception/exception.hpp"
 #include "../../include/codegen/codegen.hpp"
 #include "../../include/parser/ast.hpp"
+#include <algorithm>
 #include <iostream>
 
+void CodeGenerator::set_target(std::string cpu, std::string features) {
+    target_cpu = std::move(cpu);
+    target_features = std::move(features);
+}
+
+void CodeGenerator::set_direct_ssa(bool enabled) {
+    direct_ssa = enabled;
+}
+
+// Functions and globals may be used before their declaration, so prototypes and globals are generated first
 void CodeGenerator::generate() {
+    generate_builtins();
+    for (StmtPtr& stmt : stmts) {
+        if (stmt->kind == NodeKind::FUNC_DECL_STMT) {
+            declare_function(static_cast<const FuncDeclStmt&>(*stmt));
+        }
+    }
+    for (StmtPtr& stmt : stmts) {
+        if (stmt->kind == NodeKind::VAR_DECL_STMT) {
+            generate_stmt(*stmt);
+        }
+    }
+    for (StmtPtr& stmt : stmts) {
+        if (stmt->kind != NodeKind::VAR_DECL_STMT) {
+            generate_stmt(*stmt);
+        }
+    }
+}
+
+void CodeGenerator::generate_builtins() {
     llvm::Function* printf_func = module->getFunction("printf");
     if (!printf_func) {
         llvm::FunctionType* printf_type = llvm::FunctionType::get(builder.getInt32Ty(), llvm::PointerType::get(builder.getInt8Ty(), 0), true);
         printf_func = llvm::Function::Create(printf_type, llvm::Function::ExternalLinkage, "printf", *module);
     }
-    functions.emplace("printf", printf_func);
-    
-    for (StmtPtr& stmt : stmts) {
-        generate_stmt(*stmt);
-    }
+    bind_function(PRINTF_FUNCTION_ID, printf_func);
 }
 
 std::unique_ptr<llvm::Module> CodeGenerator::get_module() {
@@ -43,12 +71,13 @@ void CodeGenerator::print_ir() const {
     module->print(llvm::outs(), nullptr);
 }
 
-llvm::Type* CodeGenerator::get_llvm_type(Type type, Token first_token) {
-    switch (type.type) {
+llvm::Type* CodeGenerator::get_llvm_type(TypeId type, SourceLocation location) {
+    const TypeInfo& info = TypeContext::get_info(type);
+    switch (info.base) {
         case TypeValue::I8:
         case TypeValue::U8: {
             llvm::Type* llvm_type = llvm::Type::getInt8Ty(context);
-            if (type.is_pointer) {
+            if (info.pointer_depth != 0) {
                 return llvm::PointerType::get(llvm_type, 0);
             }
             return llvm_type;
@@ -56,7 +85,7 @@ llvm::Type* CodeGenerator::get_llvm_type(Type type, Token first_token) {
         case TypeValue::I16:
         case TypeValue::U16: {
             llvm::Type* llvm_type = llvm::Type::getInt16Ty(context);
-            if (type.is_pointer) {
+            if (info.pointer_depth != 0) {
                 return llvm::PointerType::get(llvm_type, 0);
             }
             return llvm_type;
@@ -64,7 +93,7 @@ llvm::Type* CodeGenerator::get_llvm_type(Type type, Token first_token) {
         case TypeValue::I32:
         case TypeValue::U32: {
             llvm::Type* llvm_type = llvm::Type::getInt32Ty(context);
-            if (type.is_pointer) {
+            if (info.pointer_depth != 0) {
                 return llvm::PointerType::get(llvm_type, 0);
             }
             return llvm_type;
@@ -72,28 +101,28 @@ llvm::Type* CodeGenerator::get_llvm_type(Type type, Token first_token) {
         case TypeValue::I64:
         case TypeValue::U64: {
             llvm::Type* llvm_type = llvm::Type::getInt64Ty(context);
-            if (type.is_pointer) {
+            if (info.pointer_depth != 0) {
                 return llvm::PointerType::get(llvm_type, 0);
             }
             return llvm_type;
         }
         case TypeValue::F32: {
             llvm::Type* llvm_type = llvm::Type::getFloatTy(context);
-            if (type.is_pointer) {
+            if (info.pointer_depth != 0) {
                 return llvm::PointerType::get(llvm_type, 0);
             }
             return llvm_type;
         }
         case TypeValue::F64: {
             llvm::Type* llvm_type = llvm::Type::getDoubleTy(context);
-            if (type.is_pointer) {
+            if (info.pointer_depth != 0) {
                 return llvm::PointerType::get(llvm_type, 0);
             }
             return llvm_type;
         }
         case TypeValue::BOOL: {
             llvm::Type* llvm_type = llvm::Type::getInt1Ty(context);
-            if (type.is_pointer) {
+            if (info.pointer_depth != 0) {
                 return llvm::PointerType::get(llvm_type, 0);
             }
             return llvm_type;
@@ -101,91 +130,331 @@ llvm::Type* CodeGenerator::get_llvm_type(Type type, Token first_token) {
         case TypeValue::NOTHING:
             return llvm::Type::getVoidTy(context);
         default: {
-            throw_error(first_token.file_name, CODEGEN, "Unsupported type\n", first_token.line);
+            throw_error(location, CODEGEN, "Unsupported type\n");
         }
     }
 }
 
 void CodeGenerator::generate_stmt(const Stmt& stmt) {
-    if (auto vds = dynamic_cast<const VarDeclStmt*>(&stmt)) {
-        generate_var_decl_stmt(*vds);
+    switch (stmt.kind) {
+        case NodeKind::VAR_DECL_STMT:
+            generate_var_decl_stmt(static_cast<const VarDeclStmt&>(stmt));
+            break;
+        case NodeKind::FUNC_DECL_STMT:
+            generate_func_decl_stmt(static_cast<const FuncDeclStmt&>(stmt));
+            break;
+        case NodeKind::FUNC_CALL_STMT:
+            generate_func_call_stmt(static_cast<const FuncCallStmt&>(stmt));
+            break;
+        case NodeKind::VAR_ASGN_STMT:
+            generate_var_asgn_stmt(static_cast<const VarAsgnStmt&>(stmt));
+            break;
+        case NodeKind::IF_STMT:
+            generate_if_stmt(static_cast<const IfStmt&>(stmt));
+            break;
+        case NodeKind::FOR_CYCLE_STMT:
+            generate_for_cycle_stmt(static_cast<const ForCycleStmt&>(stmt));
+            break;
+        case NodeKind::WHILE_CYCLE_STMT:
+            generate_while_cycle_stmt(static_cast<const WhileCycleStmt&>(stmt));
+            break;
+        case NodeKind::DO_WHILE_CYCLE_STMT:
+            generate_do_while_cycle_stmt(static_cast<const DoWhileCycleStmt&>(stmt));
+            break;
+        case NodeKind::BREAK_STMT:
+            generate_break_stmt();
+            break;
+        case NodeKind::CONTINUE_STMT:
+            generate_continue_stmt();
+            break;
+        case NodeKind::RETURN_STMT:
+            generate_return_stmt(static_cast<const ReturnStmt&>(stmt));
+            break;
+        default:
+            throw_error(stmt.location, CODEGEN, "Unsupported statement\n");
+    }
+}
+
+void CodeGenerator::generate_var_decl_stmt(const VarDeclStmt& vds) {
+    llvm::Type* var_type = get_llvm_type(vds.type, vds.location);
+    llvm::Value* var_init_val = nullptr;
+    if (vds.expr) {
+        var_init_val = generate_expr(*vds.expr);
     }
-    else if (auto fds = dynamic_cast<const FuncDeclStmt*>(&stmt)) {
-        generate_func_decl_stmt(*fds);
+    else {
+        var_init_val = llvm::Constant::getNullValue(var_type);
     }
-    else if (auto fcs = dynamic_cast<const FuncCallStmt*>(&stmt)) {
-        generate_func_call_stmt(*fcs);
+    if (blocks_deep == 0) {
+        llvm::Constant* initializer = llvm::dyn_cast<llvm::Constant>(var_init_val);
+        if (initializer == nullptr) {
+            throw_error(vds.location, CODEGEN, "Initializer of global variable '" + std::string(Interner::get_name(vds.name)) + "' is not constant\n");
+        }
+        llvm::GlobalVariable* glob_var = new llvm::GlobalVariable(*module, var_type, TypeContext::get_info(vds.type).is_const, llvm::GlobalValue::ExternalLinkage, initializer, Interner::get_name(vds.name));
+        bind_variable(vds.variable_id, glob_var);
     }
-    else if (auto vas = dynamic_cast<const VarAsgnStmt*>(&stmt)) {
-        generate_var_asgn_stmt(*vas);
+    else if (direct_ssa) {
+        declare_ssa_local(vds.variable_id, var_type, Interner::get_name(vds.name), var_init_val);
     }
-    else if (auto is = dynamic_cast<const IfStmt*>(&stmt)) {
-        generate_if_stmt(*is);
+    else {
+        llvm::AllocaInst* local_var = create_local(var_type, Interner::get_name(vds.name));
+        if (!scope_marks.empty()) {
+            builder.CreateLifetimeStart(local_var);
+            scoped_locals.push_back(local_var);
+        }
+        builder.CreateStore(var_init_val, local_var);
+        bind_variable(vds.variable_id, local_var);
     }
-    else if (auto fcs = dynamic_cast<const ForCycleStmt*>(&stmt)) {
-        generate_for_cycle_stmt(*fcs);
+}
+
+// Allocas outside of the entry block allocate on every execution and cannot be promoted to registers, so every local goes there
+llvm::AllocaInst* CodeGenerator::create_local(llvm::Type* type, std::string_view name) {
+    llvm::BasicBlock& entry = builder.GetInsertBlock()->getParent()->getEntryBlock();
+    llvm::IRBuilder<> entry_builder(context);
+    if (last_alloca == nullptr) {
+        entry_builder.SetInsertPoint(&entry, entry.begin());
     }
-    else if (auto wcs = dynamic_cast<const WhileCycleStmt*>(&stmt)) {
-        generate_while_cycle_stmt(*wcs);
+    else if (llvm::Instruction* next = last_alloca->getNextNode()) {
+        entry_builder.SetInsertPoint(next);
     }
-    else if (auto dwcs = dynamic_cast<const DoWhileCycleStmt*>(&stmt)) {
-        generate_do_while_cycle_stmt(*dwcs);
+    else {
+        entry_builder.SetInsertPoint(&entry);
     }
-    else if (dynamic_cast<const BreakStmt*>(&stmt)) {
-        generate_break_stmt();
+    last_alloca = entry_builder.CreateAlloca(type, nullptr, name);
+    return last_alloca;
+}
+
+// Locals of a nested block are live from their declaration to the end of the block, which lets their stack slots be shared
+void CodeGenerator::push_scope() {
+    scope_marks.push_back(scoped_locals.size());
+}
+
+void CodeGenerator::pop_scope() {
+    if (builder.GetInsertBlock()->getTerminator() == nullptr) {
+        end_lifetimes(scope_marks.back());
     }
-    else if (dynamic_cast<const ContinueStmt*>(&stmt)) {
-        generate_continue_stmt();
+    scoped_locals.resize(scope_marks.back());
+    scope_marks.pop_back();
+}
+
+void CodeGenerator::end_lifetimes(std::size_t mark) {
+    for (std::size_t i = scoped_locals.size(); i > mark; i--) {
+        builder.CreateLifetimeEnd(scoped_locals[i - 1]);
     }
-    else if (auto rs = dynamic_cast<const ReturnStmt*>(&stmt)) {
-        generate_return_stmt(*rs);
+}
+
+void CodeGenerator::declare_ssa_local(std::uint32_t variable_id, llvm::Type* type, std::string_view name, llvm::Value* value) {
+    if (variable_id >= ssa_locals.size()) {
+        ssa_locals.resize(variable_id + 1, { nullptr, {} });
     }
-    else {
-        throw_error(stmt.first_token.file_name, CODEGEN, "Unsupported statement\n", stmt.first_token.line);
+    ssa_locals[variable_id] = { type, name };
+    bind_variable(variable_id, nullptr);
+    write_local(variable_id, builder.GetInsertBlock(), value);
+}
+
+void CodeGenerator::write_local(std::uint32_t variable_id, llvm::BasicBlock* block, llvm::Value* value) {
+    current_defs[{ block, variable_id }] = value;
+}
+
+llvm::Value* CodeGenerator::read_local(std::uint32_t variable_id, llvm::BasicBlock* block) {
+    auto def_it = current_defs.find({ block, variable_id });
+    if (def_it != current_defs.end()) {
+        return def_it->second;
     }
+    return read_local_recursive(variable_id, block);
 }
 
-void CodeGenerator::generate_var_decl_stmt(const VarDeclStmt& vds) {
-    llvm::Type* var_type = get_llvm_type(vds.type, vds.first_token);
-    llvm::Value* var_init_val = nullptr;
-    if (vds.expr) {
-        var_init_val = implicitly_cast(generate_expr(*vds.expr), var_type, vds.first_token);
+// No definition in `block` itself, so the value comes from the predecessors. Chains of single predecessors are followed in a loop and
+// phis waiting for the values of their predecessors are kept in `reads`, so long chains of blocks (e.g. from `&&` and `||` chains) are
+// read without deep recursion
+llvm::Value* CodeGenerator::read_local_recursive(std::uint32_t variable_id, llvm::BasicBlock* block) {
+    struct PendingRead {
+        llvm::PHINode* phi;
+        llvm::pred_iterator predecessor_it;     // the predecessor being read
+        std::size_t chain_mark;
+    };
+    auto [type, name] = ssa_locals[variable_id];
+    std::vector<llvm::BasicBlock*> chain;       // blocks that get the value read next
+    std::vector<PendingRead> reads;
+    llvm::BasicBlock* current = block;
+    llvm::Value* value = nullptr;
+    bool is_first = true;       // `read_local` already looked for a definition in `block`
+    while (1) {
+        if (current != nullptr) {
+            auto def_it = is_first ? current_defs.end() : current_defs.find({ current, variable_id });
+            is_first = false;
+            if (def_it != current_defs.end()) {
+                value = def_it->second;
+            }
+            else if (!sealed_blocks.contains(current)) {
+                llvm::PHINode* phi = llvm::IRBuilder<>(current, current->begin()).CreatePHI(type, 0, name);
+                incomplete_phis[current].emplace_back(variable_id, phi);
+                write_local(variable_id, current, phi);
+                value = phi;
+            }
+            else if (llvm::BasicBlock* predecessor = current->getSinglePredecessor()) {
+                chain.push_back(current);
+                current = predecessor;
+                continue;
+            }
+            else if (llvm::pred_empty(current)) {
+                value = llvm::PoisonValue::get(type);      // unreachable block
+                write_local(variable_id, current, value);
+            }
+            else {
+                // the phi is defined before reading the predecessors, so loops end at it
+                llvm::PHINode* phi = llvm::IRBuilder<>(current, current->begin()).CreatePHI(type, 0, name);
+                write_local(variable_id, current, phi);
+                reads.push_back({ phi, llvm::pred_begin(current), chain.size() });
+                current = *reads.back().predecessor_it;
+                continue;
+            }
+            current = nullptr;
+        }
+
+        std::size_t chain_mark = reads.empty() ? 0 : reads.back().chain_mark;
+        for (; chain.size() > chain_mark; chain.pop_back()) {
+            write_local(variable_id, chain.back(), value);
+        }
+        if (reads.empty()) {
+            return value;
+        }
+        PendingRead& read = reads.back();
+        llvm::PHINode* phi = read.phi;
+        llvm::BasicBlock* phi_block = phi->getParent();
+        phi->addIncoming(value, *read.predecessor_it);
+        if (++read.predecessor_it != llvm::pred_end(phi_block)) {
+            current = *read.predecessor_it;
+            continue;
+        }
+        reads.pop_back();
+        value = remove_trivial_phi(phi);
+        write_local(variable_id, phi_block, value);
     }
-    else {
-        var_init_val = llvm::Constant::getNullValue(var_type);
+}
+
+llvm::Value* CodeGenerator::add_phi_operands(std::uint32_t variable_id, llvm::PHINode* phi) {
+    for (llvm::BasicBlock* predecessor : llvm::predecessors(phi->getParent())) {
+        phi->addIncoming(read_local(variable_id, predecessor), predecessor);
     }
-    if (blocks_deep == 0) {
-        llvm::GlobalVariable* glob_var = new llvm::GlobalVariable(*module, var_type, vds.type.is_const, llvm::GlobalValue::ExternalLinkage, llvm::dyn_cast<llvm::Constant>(var_init_val), vds.name);
-        variables.top().emplace(vds.name, glob_var);
+    return remove_trivial_phi(phi);
+}
+
+// Value `phi` merges if it merges only itself and one other value, `nullptr` if it is not trivial
+static llvm::Value* get_trivial_value(llvm::PHINode* phi) {
+    llvm::Value* same = nullptr;
+    for (llvm::Value* operand : phi->incoming_values()) {
+        if (operand == same || operand == phi) {
+            continue;
+        }
+        if (same != nullptr) {
+            return nullptr;
+        }
+        same = operand;
     }
-    else {
-        llvm::AllocaInst* local_var = builder.CreateAlloca(var_type, nullptr, vds.name);
-        builder.CreateStore(var_init_val, local_var);
-        variables.top().emplace(vds.name, local_var);
+    if (same == nullptr) {
+        same = llvm::PoisonValue::get(phi->getType());     // the phi is unreachable or in the entry block
     }
+    return same;
 }
 
-void CodeGenerator::generate_func_decl_stmt(const FuncDeclStmt& fds) {
-    llvm::Type* func_ret_type = get_llvm_type(fds.return_type, fds.first_token);
+// A phi merging only itself and one other value is replaced by that value, which may make the phis using it trivial as well. Those are
+// checked from a work list, depth first
+llvm::Value* CodeGenerator::remove_trivial_phi(llvm::PHINode* phi) {
+    llvm::Value* same = get_trivial_value(phi);
+    if (same == nullptr) {
+        return phi;
+    }
+    // `same` itself may turn out trivial below, the handle follows its replacement
+    llvm::WeakTrackingVH result(same);
+    std::vector<llvm::WeakVH> pending = { phi };
+    while (!pending.empty()) {
+        llvm::PHINode* trivial_phi = llvm::dyn_cast_or_null<llvm::PHINode>(pending.back());
+        pending.pop_back();
+        if (trivial_phi == nullptr) {
+            continue;
+        }
+        if (trivial_phi != phi) {
+            // phis still getting their operands are checked once they have all of them
+            if (trivial_phi->getNumIncomingValues() != llvm::pred_size(trivial_phi->getParent())) {
+                continue;
+            }
+            same = get_trivial_value(trivial_phi);
+            if (same == nullptr) {
+                continue;
+            }
+        }
+
+        std::size_t users_mark = pending.size();
+        for (llvm::User* user : trivial_phi->users()) {
+            if (user != trivial_phi && llvm::isa<llvm::PHINode>(user)) {
+                pending.emplace_back(user);
+            }
+        }
+        std::reverse(pending.begin() + users_mark, pending.end());
+        trivial_phi->replaceAllUsesWith(same);
+        trivial_phi->eraseFromParent();
+    }
+    return result;
+}
+
+// All predecessors of `block` are generated, so the placeholder phis in it can get their operands
+void CodeGenerator::seal_block(llvm::BasicBlock* block) {
+    auto phis_it = incomplete_phis.find(block);
+    if (phis_it != incomplete_phis.end()) {
+        std::vector<std::pair<std::uint32_t, llvm::PHINode*>> phis = std::move(phis_it->second);
+        incomplete_phis.erase(phis_it);
+        for (auto [variable_id, phi] : phis) {
+            add_phi_operands(variable_id, phi);
+        }
+    }
+    sealed_blocks.insert(block);
+}
+
+llvm::Function* CodeGenerator::declare_function(const FuncDeclStmt& fds) {
+    llvm::Type* func_ret_type = get_llvm_type(fds.return_type, fds.location);
     std::vector<llvm::Type*> param_types;
     for (const Argument& arg : fds.args) {
-        param_types.push_back(get_llvm_type(arg.type, fds.first_token));
+        param_types.push_back(get_llvm_type(arg.type, fds.location));
     }
     llvm::FunctionType* func_type = llvm::FunctionType::get(func_ret_type, param_types, false);
-    llvm::Function* func = llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, fds.name, *module);
+    llvm::Function* func = llvm::Function::Create(func_type, llvm::Function::ExternalLinkage, Interner::get_name(fds.name), *module);
+    if (!target_cpu.empty()) {
+        func->addFnAttr("target-cpu", target_cpu);
+    }
+    if (!target_features.empty()) {
+        func->addFnAttr("target-features", target_features);
+    }
+    bind_function(fds.function_id, func);
+    return func;
+}
+
+void CodeGenerator::generate_func_decl_stmt(const FuncDeclStmt& fds) {
+    llvm::Function* func = fds.function_id < functions.size() ? functions[fds.function_id] : nullptr;
+    if (func == nullptr) {
+        func = declare_function(fds);
+    }
 
     llvm::BasicBlock* entry = llvm::BasicBlock::Create(context, "entry", func);
     builder.SetInsertPoint(entry);
+    last_alloca = nullptr;
+    current_defs.clear();
+    sealed_blocks.clear();
+    incomplete_phis.clear();
+    seal_block(entry);
     blocks_deep++;
-    variables.push({});
-    functions.emplace(fds.name, func);
 
     size_t index = 0;
     for (llvm::Argument& arg : func->args()) {
-        arg.setName(fds.args[index].name);
-        llvm::AllocaInst* arg_alloca = builder.CreateAlloca(arg.getType(), nullptr, fds.args[index].name);
-        builder.CreateStore(&arg, arg_alloca);
-        variables.top().emplace(fds.args[index].name, arg_alloca);
+        std::string_view arg_name = Interner::get_name(fds.args[index].name);
+        arg.setName(arg_name);
+        if (direct_ssa) {
+            declare_ssa_local(fds.args[index].variable_id, arg.getType(), arg_name, &arg);
+        }
+        else {
+            llvm::AllocaInst* arg_alloca = create_local(arg.getType(), arg_name);
+            builder.CreateStore(&arg, arg_alloca);
+            bind_variable(fds.args[index].variable_id, arg_alloca);
+        }
         index++;
     }
     for (const StmtPtr& stmt : fds.block) {
@@ -193,85 +462,57 @@ void CodeGenerator::generate_func_decl_stmt(const FuncDeclStmt& fds) {
     }
 
     blocks_deep--;
-    variables.pop();
 }
 
 void CodeGenerator::generate_func_call_stmt(const FuncCallStmt& fcs) {
-    if (functions.empty() || functions.find(fcs.name) == functions.end()) {
-        throw_error(fcs.first_token.file_name, CODEGEN, "Function '" + fcs.name + "' does not exist\n", fcs.first_token.line);
-    }
-    
     std::vector<llvm::Value*> args;
     for (auto& arg : fcs.args) {
         args.push_back(generate_expr(*arg));
     }
-    builder.CreateCall(functions[fcs.name], args, fcs.name + ".call");
+    builder.CreateCall(functions[fcs.function_id], args, llvm::StringRef(Interner::get_name(fcs.name)) + ".call");
 }
 
 void CodeGenerator::generate_var_asgn_stmt(const VarAsgnStmt& vas) {
     llvm::Value* value = generate_expr(*vas.expr);
-    llvm::Value* var_ptr = nullptr;
-    bool have_var = false;
-    std::stack<std::map<std::string, llvm::Value*>> vars = variables;
-    while (!vars.empty()) {
-        std::map<std::string, llvm::Value*>& c_scope = vars.top();
-        auto varIt = c_scope.find(vas.name);
-        if (varIt != c_scope.end()) {
-            var_ptr = varIt->second;
-            have_var = true;
-            break;
-        }
-        vars.pop();
-    }
-    if (!have_var) {
-        throw_error(vas.first_token.file_name, CODEGEN, "Variable '" + vas.name + "' does not exist\n", vas.first_token.line);
-    }
-
-    llvm::Type* var_type;
-    if (auto global = llvm::dyn_cast<llvm::GlobalVariable>(var_ptr)) {
-        var_type = global->getValueType();
-    }
-    else if (auto local = llvm::dyn_cast<llvm::AllocaInst>(var_ptr)) {
-        var_type = local->getAllocatedType();
-    }
-    else if (auto value = llvm::dyn_cast<llvm::Value>(var_ptr)) {
-        var_type = value->getType();
+    if (variables[vas.variable_id] == nullptr) {
+        write_local(vas.variable_id, builder.GetInsertBlock(), value);
+        return;
     }
-    value = implicitly_cast(value, var_type, vas.first_token);
-
-    builder.CreateStore(value, var_ptr);
+    builder.CreateStore(value, variables[vas.variable_id]);
 }
 
 void CodeGenerator::generate_if_stmt(const IfStmt& is) {
-    llvm::Value* cond = generate_expr(*is.condition);
     llvm::Function* func = builder.GetInsertBlock()->getParent();
     
     llvm::BasicBlock* true_bb = llvm::BasicBlock::Create(context, "then", func);
     llvm::BasicBlock* false_bb = llvm::BasicBlock::Create(context, "else", func);
     llvm::BasicBlock* merge_bb = llvm::BasicBlock::Create(context, "merge", func);
 
-    builder.CreateCondBr(cond, true_bb, false_bb ? false_bb : merge_bb);
+    generate_cond_br(*is.condition, true_bb, false_bb);
+    seal_block(true_bb);
+    seal_block(false_bb);
 
     builder.SetInsertPoint(true_bb);
-    variables.push({});
+    push_scope();
     for (const StmtPtr& stmt : is.true_block) {
         generate_stmt(*stmt);
     }
-    variables.pop();
+    pop_scope();
 
     if (builder.GetInsertBlock()->getTerminator() == nullptr) {
         builder.CreateBr(merge_bb);
     }
     builder.SetInsertPoint(false_bb);
-    variables.push({});
+    push_scope();
     for (const StmtPtr& stmt : is.false_block) {
         generate_stmt(*stmt);
     }
-    variables.pop();
+    pop_scope();
     
     if (builder.GetInsertBlock()->getTerminator() == nullptr) {
         builder.CreateBr(merge_bb);
     }
+    seal_block(merge_bb);
     builder.SetInsertPoint(merge_bb);
 }
 
@@ -286,29 +527,34 @@ void CodeGenerator::generate_for_cycle_stmt(const ForCycleStmt& fcs) {
 
     builder.CreateBr(indexator_bb);
     builder.SetInsertPoint(indexator_bb);
+    seal_block(indexator_bb);
     generate_stmt(*fcs.indexator);
 
     builder.CreateBr(condition_bb);
     builder.SetInsertPoint(condition_bb);
-    llvm::Value* condition_value = generate_expr(*fcs.condition);
-
-    builder.CreateCondBr(condition_value, body_bb, exit_bb);
+    generate_cond_br(*fcs.condition, body_bb, exit_bb);
+    seal_block(body_bb);
     builder.SetInsertPoint(body_bb);
-    loop_blocks.emplace(exit_bb, iteration_bb);
+    loop_blocks.push(LoopTargets{ exit_bb, iteration_bb, scoped_locals.size() });
     blocks_deep++;
-    variables.push({});
+    push_scope();
     for (const StmtPtr& stmt : fcs.block) {
         generate_stmt(*stmt);
     }
-    variables.pop();
+    pop_scope();
     blocks_deep--;
     loop_blocks.pop();
 
-    builder.CreateBr(iteration_bb);
+    if (builder.GetInsertBlock()->getTerminator() == nullptr) {
+        builder.CreateBr(iteration_bb);
+    }
+    seal_block(iteration_bb);
     builder.SetInsertPoint(iteration_bb);
     generate_stmt(*fcs.iteration);
 
     builder.CreateBr(condition_bb);
+    seal_block(condition_bb);
+    seal_block(exit_bb);
     builder.SetInsertPoint(exit_bb);
 }
 
@@ -321,21 +567,24 @@ void CodeGenerator::generate_while_cycle_stmt(const WhileCycleStmt& wcs) {
 
     builder.CreateBr(condition_bb);
     builder.SetInsertPoint(condition_bb);
-    llvm::Value* condition_value = generate_expr(*wcs.condition);
-
-    builder.CreateCondBr(condition_value, body_bb, exit_bb);
+    generate_cond_br(*wcs.condition, body_bb, exit_bb);
+    seal_block(body_bb);
     builder.SetInsertPoint(body_bb);
-    loop_blocks.emplace(exit_bb, condition_bb);
+    loop_blocks.push(LoopTargets{ exit_bb, condition_bb, scoped_locals.size() });
     blocks_deep++;
-    variables.push({});
+    push_scope();
     for (const StmtPtr& stmt : wcs.block) {
         generate_stmt(*stmt);
     }
-    variables.pop();
+    pop_scope();
     blocks_deep--;
     loop_blocks.pop();
 
-    builder.CreateBr(condition_bb);
+    if (builder.GetInsertBlock()->getTerminator() == nullptr) {
+        builder.CreateBr(condition_bb);
+    }
+    seal_block(condition_bb);
+    seal_block(exit_bb);
     builder.SetInsertPoint(exit_bb);
 }
 
@@ -348,30 +597,36 @@ void CodeGenerator::generate_do_while_cycle_stmt(const DoWhileCycleStmt& dwcs) {
 
     builder.CreateBr(body_bb);
     builder.SetInsertPoint(body_bb);
-    loop_blocks.emplace(exit_bb, condition_bb);
+    loop_blocks.push(LoopTargets{ exit_bb, condition_bb, scoped_locals.size() });
     blocks_deep++;
-    variables.push({});
+    push_scope();
     for (const StmtPtr& stmt : dwcs.block) {
         generate_stmt(*stmt);
     }
-    variables.pop();
+    pop_scope();
     blocks_deep--;
     loop_blocks.pop();
 
-    builder.CreateBr(condition_bb);
+    if (builder.GetInsertBlock()->getTerminator() == nullptr) {
+        builder.CreateBr(condition_bb);
+    }
+    seal_block(condition_bb);
     builder.SetInsertPoint(condition_bb);
-    llvm::Value* condition_value = generate_expr(*dwcs.condition);
-    builder.CreateCondBr(condition_value, body_bb, exit_bb);
+    generate_cond_br(*dwcs.condition, body_bb, exit_bb);
+    seal_block(body_bb);
+    seal_block(exit_bb);
 
     builder.SetInsertPoint(exit_bb);
 }
 
 void CodeGenerator::generate_break_stmt() {
-    builder.CreateBr(loop_blocks.top().first);
+    end_lifetimes(loop_blocks.top().locals_mark);
+    builder.CreateBr(loop_blocks.top().break_bb);
 }
 
 void CodeGenerator::generate_continue_stmt() {
-    builder.CreateBr(loop_blocks.top().second);
+    end_lifetimes(loop_blocks.top().locals_mark);
+    builder.CreateBr(loop_blocks.top().continue_bb);
 }
 
 void CodeGenerator::generate_return_stmt(const ReturnStmt& rs) {
@@ -384,278 +639,383 @@ void CodeGenerator::generate_return_stmt(const ReturnStmt& rs) {
     builder.CreateRet(value);
 }
 
-llvm::Value* CodeGenerator::generate_expr(const Expr& expr) {
-    if (auto lit = dynamic_cast<const Literal*>(&expr)) {
-        return generate_literal(*lit);
-    }
-    else if (auto be = dynamic_cast<const BinaryExpr*>(&expr)) {
-        return generate_binary_expr(*be);
-    }
-    else if (auto ue = dynamic_cast<const UnaryExpr*>(&expr)) {
-        return generate_unary_expr(*ue);
-    }
-    else if (auto ve = dynamic_cast<const VarExpr*>(&expr)) {
-        return generate_var_expr(*ve);
-    }
-    else if (auto fce = dynamic_cast<const FuncCallExpr*>(&expr)) {
-        return generate_func_call_expr(*fce);
-    }
-    else {
-        throw_error(expr.first_token.file_name, CODEGEN, "Unsupported expression\n", expr.first_token.line);
+// Value of `root` converted as `SemanticAnalyzer` recorded. A post-order walk over `pending_exprs` that keeps the values of generated
+// operands on `operand_values`, so operator chains of any length can be generated. Calls generate their arguments with walks of their own
+llvm::Value* CodeGenerator::generate_expr(const Expr& root) {
+    std::size_t base = pending_exprs.size();
+    pending_exprs.push_back({ &root, 0, nullptr, nullptr, nullptr });
+    while (pending_exprs.size() > base) {
+        std::size_t index = pending_exprs.size() - 1;
+        const Expr& expr = *pending_exprs[index].expr;
+        unsigned char stage = pending_exprs[index].stage;
+        llvm::Value* value = nullptr;
+        switch (expr.kind) {
+            case NodeKind::LITERAL:
+                value = generate_literal(static_cast<const Literal&>(expr));
+                break;
+            case NodeKind::BINARY_EXPR: {
+                const BinaryExpr& be = static_cast<const BinaryExpr&>(expr);
+                // initializers of globals are constants and have no blocks to branch between, there `&&` and `||` are plain operators
+                if ((be.op_type == TokenType::L_AND || be.op_type == TokenType::L_OR) && blocks_deep != 0) {
+                    value = generate_logical_expr(index);
+                    break;
+                }
+                if (stage == 0) {
+                    // the left operand goes on top, so it is generated first
+                    pending_exprs[index].stage = 1;
+                    pending_exprs.push_back({ be.right, 0, nullptr, nullptr, nullptr });
+                    pending_exprs.push_back({ be.left, 0, nullptr, nullptr, nullptr });
+                    break;
+                }
+                llvm::Value* right = operand_values.back();
+                operand_values.pop_back();
+                llvm::Value* left = operand_values.back();
+                operand_values.pop_back();
+                value = generate_binary_expr(be, left, right);
+                break;
+            }
+            case NodeKind::UNARY_EXPR: {
+                const UnaryExpr& ue = static_cast<const UnaryExpr&>(expr);
+                if (stage == 0) {
+                    pending_exprs[index].stage = 1;
+                    pending_exprs.push_back({ ue.expr, 0, nullptr, nullptr, nullptr });
+                    break;
+                }
+                llvm::Value* operand = operand_values.back();
+                operand_values.pop_back();
+                value = generate_unary_expr(ue, operand);
+                break;
+            }
+            case NodeKind::VAR_EXPR:
+                value = generate_var_expr(static_cast<const VarExpr&>(expr));
+                break;
+            case NodeKind::FUNC_CALL_EXPR:
+                value = generate_func_call_expr(static_cast<const FuncCallExpr&>(expr));
+                break;
+            default:
+                throw_error(expr.location, CODEGEN, "Unsupported expression\n");
+        }
+        // `nullptr` while the operands of `expr` are pending
+        if (value == nullptr) {
+            continue;
+        }
+        pending_exprs.pop_back();
+        operand_values.push_back(convert(value, expr.type, expr.converted_type, expr.location));
     }
+    llvm::Value* value = operand_values.back();
+    operand_values.pop_back();
+    return value;
 }
 
 llvm::Value* CodeGenerator::generate_literal(const Literal& lit) {
     const auto& value = lit.value.value;
+    bool is_signed = !TypeContext::get_info(lit.type).is_unsigned();
 
-    switch (lit.type.type) {
+    switch (TypeContext::get_info(lit.type).base) {
         case TypeValue::I8:
-            return llvm::ConstantInt::get(context, llvm::APInt(8, std::get<std::int8_t>(value), !lit.type.is_unsigned));
+            return llvm::ConstantInt::get(context, llvm::APInt(8, std::get<std::int8_t>(value), is_signed));
         case TypeValue::I16:
-            return llvm::ConstantInt::get(context, llvm::APInt(16, std::get<std::int16_t>(value), !lit.type.is_unsigned));
+            return llvm::ConstantInt::get(context, llvm::APInt(16, std::get<std::int16_t>(value), is_signed));
         case TypeValue::I32:
-            return llvm::ConstantInt::get(context, llvm::APInt(32, std::get<std::int32_t>(value), !lit.type.is_unsigned));
+            return llvm::ConstantInt::get(context, llvm::APInt(32, std::get<std::int32_t>(value), is_signed));
         case TypeValue::I64:
-            return llvm::ConstantInt::get(context, llvm::APInt(64, std::get<std::int64_t>(value), !lit.type.is_unsigned));
+            return llvm::ConstantInt::get(context, llvm::APInt(64, std::get<std::int64_t>(value), is_signed));
         case TypeValue::F32:
             return llvm::ConstantFP::get(context, llvm::APFloat(std::get<std::float_t>(value)));
         case TypeValue::F64:
             return llvm::ConstantFP::get(context, llvm::APFloat(std::get<std::double_t>(value)));
         case TypeValue::U8:
-            return llvm::ConstantInt::get(context, llvm::APInt(8, std::get<std::uint8_t>(value), !lit.type.is_unsigned));
+            return llvm::ConstantInt::get(context, llvm::APInt(8, std::get<std::uint8_t>(value), is_signed));
         case TypeValue::U16:
-            return llvm::ConstantInt::get(context, llvm::APInt(16, std::get<std::uint16_t>(value), !lit.type.is_unsigned));
+            return llvm::ConstantInt::get(context, llvm::APInt(16, std::get<std::uint16_t>(value), is_signed));
         case TypeValue::U32:
-            return llvm::ConstantInt::get(context, llvm::APInt(32, std::get<std::uint32_t>(value), !lit.type.is_unsigned));
+            return llvm::ConstantInt::get(context, llvm::APInt(32, std::get<std::uint32_t>(value), is_signed));
         case TypeValue::U64:
-            return llvm::ConstantInt::get(context, llvm::APInt(64, std::get<std::uint64_t>(value), !lit.type.is_unsigned));
+            return llvm::ConstantInt::get(context, llvm::APInt(64, std::get<std::uint64_t>(value), is_signed));
         case TypeValue::BOOL:
-            return llvm::ConstantInt::get(context, llvm::APInt(1, std::get<bool>(value), !lit.type.is_unsigned));
+            return llvm::ConstantInt::get(context, llvm::APInt(1, std::get<bool>(value), is_signed));
         case TypeValue::STRING: {
-                return builder.CreateGlobalString(std::get<std::string>(value), "string_lit");
+                return builder.CreateGlobalString(std::get<std::string_view>(value), "string_lit");
             }
         default:
-            throw_error(lit.first_token.file_name, CODEGEN, "Unsupported literal\n", lit.first_token.line);
+            throw_error(lit.location, CODEGEN, "Unsupported literal\n");
     }
 }
 
-llvm::Value* CodeGenerator::generate_binary_expr(const BinaryExpr& be) {
-    llvm::Value* left = generate_expr(*be.left);
-    llvm::Value* right = generate_expr(*be.right);
-
-    auto get_common_type = [&](llvm::Value* left, llvm::Value* right) -> llvm::Type* {
-        llvm::Type* left_type = left->getType();
-        llvm::Type* right_type = right->getType();
-
-        if (left_type->isDoubleTy() || right_type->isDoubleTy()) {
-            return llvm::Type::getDoubleTy(context);
-        }
-        else if (left_type->isFloatTy() && right_type->isFloatTy()) {
-            return llvm::Type::getFloatTy(context);
+// Branches on `condition`. `&&` and `||` branch straight to the targets after each operand instead of computing a `bool` first. Nested
+// operators are handled from a work list of conditions, each with its targets and the block of the right operand it starts in
+void CodeGenerator::generate_cond_br(const Expr& condition, llvm::BasicBlock* true_bb, llvm::BasicBlock* false_bb) {
+    struct PendingBranch {
+        const Expr* condition;
+        llvm::BasicBlock* true_bb;
+        llvm::BasicBlock* false_bb;
+        llvm::BasicBlock* start_bb;
+    };
+    std::vector<PendingBranch> pending = { { &condition, true_bb, false_bb, nullptr } };
+    while (!pending.empty()) {
+        PendingBranch branch = pending.back();
+        pending.pop_back();
+        if (branch.start_bb != nullptr) {
+            seal_block(branch.start_bb);
+            builder.SetInsertPoint(branch.start_bb);
         }
-        else if (left_type->isIntegerTy() && right_type->isIntegerTy()) {
-            unsigned left_width = left_type->getIntegerBitWidth();
-            unsigned right_width = right_type->getIntegerBitWidth();
-
-            if (left_width == right_width || left_width > right_width) {
-                return left_type;
-            }
-            else {
-                return right_type;
+        const Expr& expr = *branch.condition;
+        if (expr.kind == NodeKind::BINARY_EXPR && expr.type == expr.converted_type) {
+            const BinaryExpr& be = static_cast<const BinaryExpr&>(expr);
+            if (be.op_type == TokenType::L_AND || be.op_type == TokenType::L_OR) {
+                bool is_and = be.op_type == TokenType::L_AND;
+                llvm::BasicBlock* right_bb = llvm::BasicBlock::Create(context, is_and ? "land.rhs" : "lor.rhs", builder.GetInsertBlock()->getParent());
+                // the left operand goes on top, so it branches before the right one starts
+                pending.push_back({ be.right, branch.true_bb, branch.false_bb, right_bb });
+                if (is_and) {
+                    pending.push_back({ be.left, right_bb, branch.false_bb, nullptr });
+                }
+                else {
+                    pending.push_back({ be.left, branch.true_bb, right_bb, nullptr });
+                }
+                continue;
             }
         }
+        builder.CreateCondBr(generate_expr(expr), branch.true_bb, branch.false_bb);
+    }
+}
 
+// `&&` and `||` evaluate the right operand only if the left one does not decide the result. Called by `generate_expr` at every stage of
+// `pending_exprs[index]`: first it creates the blocks and pushes the left operand, then branches on its value and pushes the right one,
+// then joins the two. `nullptr` until the last stage
+llvm::Value* CodeGenerator::generate_logical_expr(std::size_t index) {
+    PendingExpr& pending = pending_exprs[index];
+    const BinaryExpr& be = static_cast<const BinaryExpr&>(*pending.expr);
+    bool is_and = be.op_type == TokenType::L_AND;
+    if (pending.stage == 0) {
+        llvm::Function* function = builder.GetInsertBlock()->getParent();
+        pending.right_bb = llvm::BasicBlock::Create(context, is_and ? "land.rhs" : "lor.rhs", function);
+        pending.end_bb = llvm::BasicBlock::Create(context, is_and ? "land.end" : "lor.end", function);
+        pending.stage = 1;
+        pending_exprs.push_back({ be.left, 0, nullptr, nullptr, nullptr });
         return nullptr;
-    };
-    
-    llvm::Type* left_type = left->getType();
-    llvm::Type* right_type = right->getType();
-    llvm::Type* common_type = get_common_type(left, right);
-    if (common_type == nullptr) {
-        std::cerr << "codegen: There is no common type between ";
-        left_type->print(llvm::outs());
-        std::cerr << " and ";
-        right->getType()->print(llvm::outs());
-        std::cerr << '\n';
-        exit(1);
-    }
-    if (left_type != common_type) {
-        left = implicitly_cast(left, common_type, be.first_token);
-        left_type = left->getType();
-    }
-    else if (right_type != common_type) {
-        right = implicitly_cast(right, common_type, be.first_token);
-        right_type = right->getType();
     }
+    if (pending.stage == 1) {
+        llvm::Value* left = operand_values.back();
+        operand_values.pop_back();
+        pending.left_end_bb = builder.GetInsertBlock();
+        builder.CreateCondBr(left, is_and ? pending.right_bb : pending.end_bb, is_and ? pending.end_bb : pending.right_bb);
+        seal_block(pending.right_bb);
+        builder.SetInsertPoint(pending.right_bb);
+        pending.stage = 2;
+        pending_exprs.push_back({ be.right, 0, nullptr, nullptr, nullptr });
+        return nullptr;
+    }
+    llvm::Value* right = operand_values.back();
+    operand_values.pop_back();
+    llvm::BasicBlock* right_end_bb = builder.GetInsertBlock();
+    builder.CreateBr(pending.end_bb);
+    seal_block(pending.end_bb);
+
+    builder.SetInsertPoint(pending.end_bb);
+    llvm::PHINode* result = builder.CreatePHI(builder.getInt1Ty(), 2, is_and ? "landtmp" : "lortmp");
+    result->addIncoming(builder.getInt1(!is_and), pending.left_end_bb);
+    result->addIncoming(right, right_end_bb);
+    return result;
+}
+
+// `left` and `right` are the generated operands. `&&` and `||` get here only in initializers of globals, where `builder` folds the select
+llvm::Value* CodeGenerator::generate_binary_expr(const BinaryExpr& be, llvm::Value* left, llvm::Value* right) {
+    if (be.op_type == TokenType::L_AND || be.op_type == TokenType::L_OR) {
+        return be.op_type == TokenType::L_AND ? builder.CreateLogicalAnd(left, right, "landtmp") : builder.CreateLogicalOr(left, right, "lortmp");
+    }
+
+    // both operands are already converted to their common type
+    const TypeInfo& operands_info = TypeContext::get_info(be.left->converted_type);
+    bool is_float = operands_info.is_float();
+    bool is_unsigned = is_unsigned_int(operands_info);
+
     switch (be.op_type) {
         case TokenType::PLUS:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFAdd(left, right, "addtmp");
             }
             else {
                 return builder.CreateAdd(left, right, "addtmp");
             }
         case TokenType::MINUS:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFSub(left, right, "subtmp");
             }
             else {
                 return builder.CreateSub(left, right, "subtmp");
             }
         case TokenType::MULT:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFMul(left, right, "multmp");
             }
             else {
                 return builder.CreateMul(left, right, "multmp");
             }
         case TokenType::DIV:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFDiv(left, right, "divtmp");
             }
             else {
-                return builder.CreateSDiv(left, right, "divtmp");
+                return is_unsigned ? builder.CreateUDiv(left, right, "divtmp") : builder.CreateSDiv(left, right, "divtmp");
             }
         case TokenType::MODULO:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFRem(left, right, "remtmp");
             }
             else {
-                return builder.CreateSRem(left, right, "remtmp");
+                return is_unsigned ? builder.CreateURem(left, right, "remtmp") : builder.CreateSRem(left, right, "remtmp");
             }
         case TokenType::GT:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFCmpOGT(left, right, "gttmp");
             }
             else {
-                return builder.CreateICmpSGT(left, right, "gttmp");
+                return is_unsigned ? builder.CreateICmpUGT(left, right, "gttmp") : builder.CreateICmpSGT(left, right, "gttmp");
             }
         case TokenType::GT_EQ:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFCmpOGE(left, right, "getmp");
             }
             else {
-                return builder.CreateICmpSGE(left, right, "getmp");
+                return is_unsigned ? builder.CreateICmpUGE(left, right, "getmp") : builder.CreateICmpSGE(left, right, "getmp");
             }
         case TokenType::LS:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFCmpOLT(left, right, "lttmp");
             }
             else {
-                return builder.CreateICmpSLT(left, right, "lttmp");
+                return is_unsigned ? builder.CreateICmpULT(left, right, "lttmp") : builder.CreateICmpSLT(left, right, "lttmp");
             }
         case TokenType::LS_EQ:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFCmpOLE(left, right, "letmp");
             }
             else {
-                return builder.CreateICmpSLE(left, right, "letmp");
+                return is_unsigned ? builder.CreateICmpULE(left, right, "letmp") : builder.CreateICmpSLE(left, right, "letmp");
             }
         case TokenType::EQ_EQ:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFCmpOEQ(left, right, "eqtmp");
             }
             else {
                 return builder.CreateICmpEQ(left, right, "eqtmp");
             }
         case TokenType::NOT_EQ:
-            if (left_type->isFloatingPointTy() || right_type->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFCmpONE(left, right, "netmp");
             }
             else {
                 return builder.CreateICmpNE(left, right, "netmp");
             }
-        case TokenType::L_AND:
-            return builder.CreateLogicalAnd(left, right, "landtmp");
-        case TokenType::L_OR:
-            return builder.CreateLogicalOr(left, right, "lortmp");
+        case TokenType::B_AND:
+            return builder.CreateAnd(left, right, "andtmp");
+        case TokenType::B_OR:
+            return builder.CreateOr(left, right, "ortmp");
+        case TokenType::B_XOR:
+            return builder.CreateXor(left, right, "xortmp");
+        case TokenType::L_SHIFT:
+            return builder.CreateShl(left, right, "shltmp");
+        case TokenType::R_SHIFT:
+            return is_unsigned ? builder.CreateLShr(left, right, "shrtmp") : builder.CreateAShr(left, right, "shrtmp");
         default: {}
     }
 }
 
-llvm::Value* CodeGenerator::generate_unary_expr(const UnaryExpr& ue) {
-    llvm::Value* value = generate_expr(*ue.expr);
-    
+llvm::Value* CodeGenerator::generate_unary_expr(const UnaryExpr& ue, llvm::Value* value) {
+    bool is_float = TypeContext::get_info(ue.expr->converted_type).is_float();
+
     switch (ue.op_type) {
         case TokenType::MINUS:
-            if (value->getType()->isFloatingPointTy()) {
+            if (is_float) {
                 return builder.CreateFNeg(value, "negtmp");
             }
             else {
                 return builder.CreateNeg(value, "negtmp");
             }
         case TokenType::L_NOT:
-            if (value->getType()->isFloatingPointTy()) {
-                return builder.CreateFCmpOEQ(value, builder.getInt32(0), "lnottmp");
+            if (is_float) {
+                return builder.CreateFCmpOEQ(value, llvm::Constant::getNullValue(value->getType()), "lnottmp");
             }
             else {
-                return builder.CreateICmpEQ(value, builder.getInt32(0), "lnottmp");
+                return builder.CreateICmpEQ(value, llvm::Constant::getNullValue(value->getType()), "lnottmp");
             }
+        case TokenType::B_NOT:
+            return builder.CreateNot(value, "nottmp");
         default: {}
     }
 }
 
 llvm::Value* CodeGenerator::generate_var_expr(const VarExpr& ve) {
-    std::stack<std::map<std::string, llvm::Value*>> vars = variables;
-    while (!vars.empty()) {
-        std::map<std::string, llvm::Value*>& c_scope = vars.top();
-        auto var_it = c_scope.find(ve.name);
-        if (var_it != c_scope.end()) {
-            llvm::Type* type = nullptr;
-            if (auto global = llvm::dyn_cast<llvm::GlobalVariable>(var_it->second)) {
-                type = global->getValueType();
-            }
-            else if (auto local = llvm::dyn_cast<llvm::AllocaInst>(var_it->second)) {
-                type = local->getAllocatedType();
-            }
-            else if (auto value = llvm::dyn_cast<llvm::Value>(var_it->second)) {
-                type = value->getType();
-            }
-            return builder.CreateLoad(type, var_it->second, ve.name + ".load");
-        }
-        vars.pop();
+    if (variables[ve.variable_id] == nullptr) {
+        return read_local(ve.variable_id, builder.GetInsertBlock());
     }
-
-    throw_error(ve.first_token.file_name, CODEGEN, "Variable '" + ve.name + "' does not exist\n", ve.first_token.line);
+    // the initializer of a global can only read `const` globals, and outside of functions there is nothing to load with
+    if (blocks_deep == 0) {
+        return llvm::cast<llvm::GlobalVariable>(variables[ve.variable_id])->getInitializer();
+    }
+    return builder.CreateLoad(get_llvm_type(ve.type, ve.location), variables[ve.variable_id], llvm::StringRef(Interner::get_name(ve.name)) + ".load");
 }
 
 llvm::Value* CodeGenerator::generate_func_call_expr(const FuncCallExpr& fce) {
-    if (functions.empty() || functions.find(fce.name) == functions.end()) {
-        throw_error(fce.first_token.file_name, CODEGEN, "Function '" + fce.name + "' does not exist\n", fce.first_token.line);
-    }
-    
     std::vector<llvm::Value*> args;
     for (auto& arg : fce.args) {
         args.push_back(generate_expr(*arg));
     }
-    return builder.CreateCall(functions[fce.name], args, fce.name + ".call");
+    return builder.CreateCall(functions[fce.function_id], args, llvm::StringRef(Interner::get_name(fce.name)) + ".call");
 }
 
-llvm::Value* CodeGenerator::implicitly_cast(llvm::Value* value, llvm::Type* expected_type, Token first_token) {
-    llvm::Type* value_type = value->getType();
+void CodeGenerator::bind_variable(std::uint32_t variable_id, llvm::Value* value) {
+    if (variable_id >= variables.size()) {
+        variables.resize(variable_id + 1, nullptr);
+    }
+    variables[variable_id] = value;
+}
 
-    if (value_type == expected_type)  {
+void CodeGenerator::bind_function(std::uint32_t function_id, llvm::Function* function) {
+    if (function_id >= functions.size()) {
+        functions.resize(function_id + 1, nullptr);
+    }
+    functions[function_id] = function;
+}
+
+// Booleans and unsigned integers are extended with zeros and converted to floats as unsigned
+bool CodeGenerator::is_unsigned_int(const TypeInfo& info) const {
+    return info.pointer_depth == 0 && (info.is_unsigned() || info.base == TypeValue::BOOL);
+}
+
+// Lowers a conversion recorded by `SemanticAnalyzer`. Values converted to `bool` are compared with zero
+llvm::Value* CodeGenerator::convert(llvm::Value* value, TypeId from, TypeId to, SourceLocation location) {
+    if (from == to) {
         return value;
     }
-    else if (value_type->isIntegerTy() && expected_type->isIntegerTy()) {
-        unsigned long value_width = value_type->getIntegerBitWidth();
-        unsigned long expected_width = expected_type->getIntegerBitWidth();
+    const TypeInfo& from_info = TypeContext::get_info(from);
+    const TypeInfo& to_info = TypeContext::get_info(to);
+    llvm::Type* value_type = value->getType();
+    llvm::Type* expected_type = get_llvm_type(to, location);
 
-        if (value_width == expected_width) {
-            return value;
+    if (to_info.base == TypeValue::BOOL && to_info.pointer_depth == 0 && value_type != expected_type) {
+        if (value_type->isFloatingPointTy()) {
+            return builder.CreateFCmpUNE(value, llvm::Constant::getNullValue(value_type), "booltmp");
         }
-        else if (value_width > expected_width) {
+        return builder.CreateICmpNE(value, llvm::Constant::getNullValue(value_type), "booltmp");
+    }
+    if (value_type == expected_type) {
+        return value;
+    }
+    else if (value_type->isIntegerTy() && expected_type->isIntegerTy()) {
+        if (value_type->getIntegerBitWidth() > expected_type->getIntegerBitWidth()) {
             return builder.CreateTrunc(value, expected_type, "trunctmp");
         }
+        else if (is_unsigned_int(from_info)) {
+            return builder.CreateZExt(value, expected_type, "zexttmp");
+        }
         else {
             return builder.CreateSExt(value, expected_type, "sexttmp");
         }
     }
     else if (value_type->isFloatingPointTy() && expected_type->isFloatingPointTy()) {
-        if (value_type->isFloatTy() && expected_type->isFloatTy() || value_type->isDoubleTy() && expected_type->isDoubleTy()) {
-            return value;
-        }
-        else if (value_type->isFloatTy() && expected_type->isDoubleTy()) {
+        if (value_type->isFloatTy() && expected_type->isDoubleTy()) {
             return builder.CreateFPExt(value, expected_type, "fpexttmp");
         }
         else {
@@ -663,10 +1023,20 @@ llvm::Value* CodeGenerator::implicitly_cast(llvm::Value* value, llvm::Type* expe
         }
     }
     else if (value_type->isIntegerTy() && expected_type->isFloatingPointTy()) {
+        if (is_unsigned_int(from_info)) {
+            return builder.CreateUIToFP(value, expected_type, "uitofptmp");
+        }
         return builder.CreateSIToFP(value, expected_type, "sitofptmp");
     }
+    else if (value_type->isFloatingPointTy() && expected_type->isIntegerTy()) {
+        if (is_unsigned_int(to_info)) {
+            return builder.CreateFPToUI(value, expected_type, "fptouitmp");
+        }
+        return builder.CreateFPToSI(value, expected_type, "fptositmp");
+    }
 
-    std::cerr << "In file: " << first_token.file_name << ':' << first_token.line << ":\n";
+    ResolvedLocation resolved = SourceManager::resolve(location);
+    std::cerr << "In file: " << SourceManager::get_path(resolved.file_id) << ':' << resolved.line << ':' << resolved.column << ":\n";
     std::cerr << "codegen: Unknown type to implicitly cast (";
     value_type->print(llvm::outs());
     std::cerr << " to ";
@@ -1,3 +1,4 @@
+#include "../../include/source/source_manager.hpp"
 #include "../../include/exception/exception.hpp"
 #include <iostream>
 
@@ -14,8 +15,26 @@ std::string subsystem_type_to_string(SubsystemType type) {
     }
 }
 
-void throw_error(std::string file_name, SubsystemType subsystem_type, std::string message, int line, std::uint8_t error_code) {
-    std::cerr << "In file: " << file_name << ':' << line << ":\n";
-    std::cerr << subsystem_type_to_string(subsystem_type) << ": " << message;
-    exit(error_code);
+static thread_local bool errors_deferred = false;
+
+DeferredErrorsScope::DeferredErrorsScope() : previous(errors_deferred) {
+    errors_deferred = true;
+}
+
+DeferredErrorsScope::~DeferredErrorsScope() {
+    errors_deferred = previous;
+}
+
+void throw_error(SourceLocation location, SubsystemType subsystem_type, std::string message, std::uint8_t error_code) {
+    if (errors_deferred) {
+        throw CompileError{ location, subsystem_type, std::move(message), error_code };
+    }
+    report_error(CompileError{ location, subsystem_type, std::move(message), error_code });
+}
+
+void report_error(const CompileError& error) {
+    ResolvedLocation resolved = SourceManager::resolve(error.location);
+    std::cerr << "In file: " << SourceManager::get_path(resolved.file_id) << ':' << resolved.line << ':' << resolved.column << ":\n";
+    std::cerr << subsystem_type_to_string(error.subsystem_type) << ": " << error.message;
+    exit(error.error_code);
 }
\ No newline at end of file
@@ -1,13 +1,18 @@
+#include "../../include/source/source_manager.hpp"
 #include "../../include/exception/exception.hpp"
+#include "../../include/lexer/scanner.hpp"
 #include "../../include/lexer/lexer.hpp"
 #include <algorithm>
 #include <filesystem>
-#include <fstream>
-#include <map>
+#include <charconv>
 
-std::vector<std::string> Lexer::included_files_paths;
+struct Keyword {
+    std::string_view text = "";
+    TokenType type = TokenType::ID;
+};
 
-std::map<std::string, TokenType> keywords = {
+// The only keyword list: the perfect hash table below is generated from it at compile time
+constexpr Keyword keyword_list[] = {
     {"i8", TokenType::I8},
     {"i16", TokenType::I16},
     {"i32", TokenType::I32},
@@ -35,17 +40,152 @@ std::map<std::string, TokenType> keywords = {
     {"break", TokenType::BREAK},
     {"continue", TokenType::CONTINUE},
     {"return", TokenType::RETURN},
+
+    {"true", TokenType::BOOL_LIT},
+    {"false", TokenType::BOOL_LIT},
 };
 
+constexpr unsigned KEYWORD_TABLE_SIZE = 64;
+constexpr unsigned KEYWORD_MAX_LENGTH = 8;
+
+constexpr unsigned keyword_hash(std::string_view text, unsigned seed) {
+    unsigned char first = text[0];
+    unsigned char second = text.length() > 1 ? text[1] : 0;
+    unsigned char last = text[text.length() - 1];
+    return ((first * seed) ^ (second * (seed >> 4)) ^ (last * 7) ^ text.length()) % KEYWORD_TABLE_SIZE;
+}
+
+constexpr bool is_keyword_seed_perfect(unsigned seed) {
+    bool used[KEYWORD_TABLE_SIZE] = {};
+    for (const Keyword& keyword : keyword_list) {
+        unsigned slot = keyword_hash(keyword.text, seed);
+        if (used[slot]) {
+            return false;
+        }
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr unsigned find_keyword_seed() {
+    for (unsigned seed = 1; seed < 4096; seed++) {
+        if (is_keyword_seed_perfect(seed)) {
+            return seed;
+        }
+    }
+    return 0;
+}
+
+constexpr unsigned keyword_seed = find_keyword_seed();
+static_assert(keyword_seed != 0, "No perfect hash seed for the keyword list");
+
+struct KeywordTable {
+    Keyword slots[KEYWORD_TABLE_SIZE];
+
+    constexpr KeywordTable() : slots{} {
+        for (const Keyword& keyword : keyword_list) {
+            slots[keyword_hash(keyword.text, keyword_seed)] = keyword;
+        }
+    }
+};
+
+constexpr KeywordTable keyword_table;
+
+static TokenType classify_identifier(std::string_view text) {
+    if (text.length() > KEYWORD_MAX_LENGTH) {
+        return TokenType::ID;
+    }
+    const Keyword& slot = keyword_table.slots[keyword_hash(text, keyword_seed)];
+    return slot.text == text ? slot.type : TokenType::ID;
+}
+
+struct LiteralSuffix {
+    std::string_view text;
+    TokenType type;
+};
+
+constexpr LiteralSuffix literal_suffixes[] = {
+    {"i8", TokenType::I8_LIT},
+    {"i16", TokenType::I16_LIT},
+    {"i32", TokenType::I32_LIT},
+    {"i64", TokenType::I64_LIT},
+    {"u8", TokenType::U8_LIT},
+    {"u16", TokenType::U16_LIT},
+    {"u32", TokenType::U32_LIT},
+    {"u64", TokenType::U64_LIT},
+    {"f32", TokenType::F32_LIT},
+    {"f64", TokenType::F64_LIT},
+};
+
+static std::uint64_t get_literal_max_value(TokenType type) {
+    switch (type) {
+        case TokenType::I8_LIT:
+            return INT8_MAX;
+        case TokenType::I16_LIT:
+            return INT16_MAX;
+        case TokenType::I32_LIT:
+            return INT32_MAX;
+        case TokenType::I64_LIT:
+            return INT64_MAX;
+        case TokenType::U8_LIT:
+            return UINT8_MAX;
+        case TokenType::U16_LIT:
+            return UINT16_MAX;
+        case TokenType::U32_LIT:
+            return UINT32_MAX;
+        default:
+            return UINT64_MAX;
+    }
+}
+
+static bool is_digit_of_radix(char c, int radix) {
+    switch (radix) {
+        case 2:
+            return c == '0' || c == '1';
+        case 16:
+            return std::isxdigit(c);
+        default:
+            return std::isdigit(c);
+    }
+}
+
+Lexer::Lexer(std::uint32_t fid) : source(SourceManager::get_content(fid)), source_len(source.length()), pos(0), file_id(fid),
+                                  base_location(SourceManager::get_base(fid)) {}
+
 std::vector<Token> Lexer::tokenize() {
-    while (pos < source_len) {
+    std::vector<Token> tokens;
+    tokens.reserve(source_len / 4);
+    while (1) {
+        Token token = next_token();
+        if (token.type == TokenType::END_OF_FILE) {
+            break;
+        }
+        tokens.push_back(token);
+    }
+
+    return tokens;
+}
+
+Token Lexer::next_token() {
+    while (1) {
+        if (include_lexer) {
+            Token token = include_lexer->next_token();
+            if (token.type != TokenType::END_OF_FILE) {
+                return token;
+            }
+            include_lexer.reset();
+        }
+        if (pos >= source_len) {
+            return Token(TokenType::END_OF_FILE, "", get_location());
+        }
+
         const char c = peek();
         if (c == '$') {
             advance();
             handle_preprocessor();
         }
         else if (c == '\n' || c == ' ') {
-            advance();
+            advance_to(scan_whitespace(source.data() + pos) - source.data());
         }
         else if (c == '/') {
             if (peek(1) == '/') {
@@ -55,271 +195,352 @@ std::vector<Token> Lexer::tokenize() {
                 skip_multiline_comment();
             }
             else {
-                tokens.push_back(tokenize_op());
+                return tokenize_op();
             }
         }
         else if (std::isdigit(c)) {
-            tokens.push_back(tokenize_number());
+            return tokenize_number();
         }
         else if (c == '"') {
-            tokens.push_back(tokenize_string());
+            return tokenize_string();
         }
         else if (c == '\'') {
-            tokens.push_back(tokenize_char());
+            return tokenize_char();
         }
         else if (std::isalpha(c) || c == '_') {
-            tokens.push_back(tokenize_id_or_keyword());
+            return tokenize_id_or_keyword();
         }
         else {
-            tokens.push_back(tokenize_op());
+            return tokenize_op();
         }
     }
-
-    return tokens;
 }
 
 Token Lexer::tokenize_number() {
-    std::string val;
-    int tmp_l = line;
-    int tmp_c = column;
-    bool has_dot = false;
+    std::size_t start = pos;
+    SourceLocation location = get_location();
+    int radix = 10;
+    if (peek() == '0' && (peek(1) == 'x' || peek(1) == 'X')) {
+        radix = 16;
+        pos += 2;
+    }
+    else if (peek() == '0' && (peek(1) == 'b' || peek(1) == 'B')) {
+        radix = 2;
+        pos += 2;
+    }
 
-    while (pos < source_len && (std::isdigit(peek()) || peek() == '.')) {
-        if (peek() == '.') {
-            if (has_dot) {
-                throw_error(file_name, LEXER, "Invalid number literal (" + std::to_string(line) + ':' + std::to_string(column) + ")\n", line);
+    // digits are copied without `_` separators, because `std::from_chars` does not skip them
+    char digits[128];
+    unsigned digits_len = 0;
+    bool has_dot = false;
+    bool has_exponent = false;
+    while (true) {
+        const char c = peek();
+        if (c == '_') {
+            advance();
+            continue;
+        }
+        if (c == '.' && radix == 10) {
+            if (has_dot || has_exponent) {
+                throw_error(get_location(), LEXER, "Invalid number literal\n");
             }
             has_dot = true;
         }
-        val += advance();
+        else if ((c == 'e' || c == 'E') && radix == 10 && !has_exponent && digits_len != 0
+                 && (std::isdigit(peek(1)) || ((peek(1) == '+' || peek(1) == '-') && std::isdigit(peek(2))))) {
+            has_exponent = true;
+            digits[digits_len++] = advance();
+        }
+        else if (!is_digit_of_radix(c, radix)) {
+            break;
+        }
+        if (digits_len >= sizeof(digits) - 1) {
+            throw_error(location, LEXER, "Number literal is too long\n");
+        }
+        digits[digits_len++] = advance();
     }
-    if (has_dot) {
-        return Token(TokenType::F64_LIT, val, tmp_l, tmp_c, file_name);
+    if (digits_len == 0) {
+        throw_error(location, LEXER, "Invalid number literal\n");
     }
-    return Token(TokenType::I32_LIT, val, tmp_l, tmp_c, file_name);
-}
+    bool is_float = has_dot || has_exponent;
 
-Token Lexer::tokenize_string() {
-    std::string val;
-    int tmp_l = line;
-    int tmp_c = column;
+    // the suffix (`10u64`, `1.5f32`) is the rest of the identifier-like run after the digits
+    std::size_t suffix_start = pos;
+    pos = scan_identifier(source.data() + pos) - source.data();
+    std::string_view suffix = source.substr(suffix_start, pos - suffix_start);
+    std::string_view val = source.substr(start, pos - start);
 
-    advance();
-    while (pos < source_len && peek() != '"') {
-        if (peek() == '\\') {
-            advance();
-            val += advance_escape_sequence();
+    TokenType type = is_float ? TokenType::F64_LIT : TokenType::I32_LIT;
+    if (!suffix.empty()) {
+        auto suffix_it = std::find_if(std::begin(literal_suffixes), std::end(literal_suffixes), [&](const LiteralSuffix& literal_suffix) {
+            return literal_suffix.text == suffix;
+        });
+        if (suffix_it == std::end(literal_suffixes)) {
+            throw_error(get_location() - suffix.length(), LEXER, "Invalid number literal suffix '" + std::string(suffix) + "'\n");
         }
-        else {
-            val += advance();
+        type = suffix_it->type;
+    }
+    bool is_float_type = type == TokenType::F32_LIT || type == TokenType::F64_LIT;
+    if (is_float && !is_float_type) {
+        throw_error(location, LEXER, "Floating-point literal can not have an integer suffix\n");
+    }
+
+    Token token(type, val, location);
+    if (is_float) {
+        double value;
+        if (type == TokenType::F32_LIT) {
+            float float_value;
+            if (std::from_chars(digits, digits + digits_len, float_value).ec != std::errc()) {
+                throw_error(location, LEXER, "Floating-point literal is out of range\n");
+            }
+            value = float_value;
         }
+        else if (std::from_chars(digits, digits + digits_len, value).ec != std::errc()) {
+            throw_error(location, LEXER, "Floating-point literal is out of range\n");
+        }
+        token.float_value = value;
+        return token;
+    }
+
+    std::uint64_t value;
+    if (std::from_chars(digits, digits + digits_len, value, radix).ec != std::errc()) {
+        throw_error(location, LEXER, "Integer literal is too large\n");
+    }
+    if (is_float_type) {
+        token.float_value = value;
+        return token;
+    }
+    if (suffix.empty() && value > INT32_MAX) {
+        token.type = value > INT64_MAX ? TokenType::U64_LIT : TokenType::I64_LIT;
     }
+    else if (value > get_literal_max_value(token.type)) {
+        throw_error(location, LEXER, "Integer literal does not fit into its type\n");
+    }
+    token.int_value = value;
+    return token;
+}
+
+Token Lexer::tokenize_string() {
+    SourceLocation location = get_location();
+
+    advance();
+    std::size_t start = pos;
+    skip_quoted('"', location);
+    std::string_view val = source.substr(start, pos - start);
     advance();
 
-    return Token(TokenType::STRING_LIT, val, tmp_l, tmp_c, file_name);
+    return Token(TokenType::STRING_LIT, val, location);
 }
 
 Token Lexer::tokenize_char() {
-    std::string val;
-    int tmp_l = line;
-    int tmp_c = column;
+    SourceLocation location = get_location();
 
     advance();
-    while (pos < source_len && peek() != '\'') {
-        if (peek() == '\\') {
-            advance();
-            val += advance_escape_sequence();
-        }
-        else {
-            val += advance();
-        }
-    }
+    std::size_t start = pos;
+    skip_quoted('\'', location);
+    std::string_view val = source.substr(start, pos - start);
     advance();
 
-    return Token(TokenType::I8_LIT, val, tmp_l, tmp_c, file_name);
+    Token token(TokenType::I8_LIT, val, location);
+    token.int_value = static_cast<unsigned char>(unescape_string(val)[0]);
+    return token;
 }
 
 Token Lexer::tokenize_id_or_keyword() {
-    std::string val;
-    int tmp_l = line;
-    int tmp_c = column;
+    std::size_t start = pos;
+    SourceLocation location = get_location();
 
-    while (pos < source_len && (std::isalpha(peek()) || peek() == '_' || std::isdigit(peek()))) {
-        val += advance();
-    }
+    pos = scan_identifier(source.data() + pos) - source.data();
+    std::string_view val = source.substr(start, pos - start);
 
-    if (keywords.find(val) != keywords.end()) {
-        return Token(keywords[val], val, tmp_l, tmp_c, file_name);
-    }
-    else if (val == "true" || val == "false") {
-        return Token(TokenType::BOOL_LIT, val, tmp_l, tmp_c, file_name);
+    Token token(classify_identifier(val), val, location);
+    if (token.type == TokenType::ID) {
+        token.symbol = Interner::intern(val);
     }
-    return Token(TokenType::ID, val, tmp_l, tmp_c, file_name);
+    return token;
 }
 
 Token Lexer::tokenize_op() {
     const char c = peek();
-    int tmp_l = line;
-    int tmp_c = column;
+    SourceLocation location = get_location();
     switch (c) {
         case '(':
             advance();
-            return Token(TokenType::LPAREN, "(", tmp_l, tmp_c, file_name);
+            return Token(TokenType::LPAREN, "(", location);
         case ')':
             advance();
-            return Token(TokenType::RPAREN, ")", tmp_l, tmp_c, file_name);
+            return Token(TokenType::RPAREN, ")", location);
         case '[':
             advance();
-            return Token(TokenType::LBRACKET, "{", tmp_l, tmp_c, file_name);
+            return Token(TokenType::LBRACKET, "{", location);
         case ']':
             advance();
-            return Token(TokenType::RBRACKET, "}", tmp_l, tmp_c, file_name);
+            return Token(TokenType::RBRACKET, "}", location);
         case '{':
             advance();
-            return Token(TokenType::LBRACE, "{", tmp_l, tmp_c, file_name);
+            return Token(TokenType::LBRACE, "{", location);
         case '}':
             advance();
-            return Token(TokenType::RBRACE, "}", tmp_l, tmp_c, file_name);
+            return Token(TokenType::RBRACE, "}", location);
         case ';':
             advance();
-            return Token(TokenType::SEMICOLON, ";", tmp_l, tmp_c, file_name);
+            return Token(TokenType::SEMICOLON, ";", location);
         case ':':
             advance();
-            return Token(TokenType::COLON, ":", tmp_l, tmp_c, file_name);
+            return Token(TokenType::COLON, ":", location);
         case ',':
             advance();
-            return Token(TokenType::COMMA, ",", tmp_l, tmp_c, file_name);
+            return Token(TokenType::COMMA, ",", location);
         case '.':
             advance();
-            return Token(TokenType::DOT, ".", tmp_l, tmp_c, file_name);
+            return Token(TokenType::DOT, ".", location);
         case '?':
             advance();
-            return Token(TokenType::QUESTION, "?", tmp_l, tmp_c, file_name);
+            return Token(TokenType::QUESTION, "?", location);
         case '+':
             advance();
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::PLUS_EQ, "+=", tmp_l, tmp_c, file_name);
+                return Token(TokenType::PLUS_EQ, "+=", location);
             }
-            return Token(TokenType::PLUS, "+", tmp_l, tmp_c, file_name);
+            return Token(TokenType::PLUS, "+", location);
         case '-':
             advance();
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::MINUS_EQ, "-=", tmp_l, tmp_c, file_name);
+                return Token(TokenType::MINUS_EQ, "-=", location);
             }
-            return Token(TokenType::MINUS, "-", tmp_l, tmp_c, file_name);
+            return Token(TokenType::MINUS, "-", location);
         case '*':
             advance();
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::MULT_EQ, "*=", tmp_l, tmp_c, file_name);
+                return Token(TokenType::MULT_EQ, "*=", location);
             }
-            return Token(TokenType::MULT, "*", tmp_l, tmp_c, file_name);
+            return Token(TokenType::MULT, "*", location);
         case '/':
             advance();
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::DIV_EQ, "/=", tmp_l, tmp_c, file_name);
+                return Token(TokenType::DIV_EQ, "/=", location);
             }
-            return Token(TokenType::DIV, "/", tmp_l, tmp_c, file_name);
+            return Token(TokenType::DIV, "/", location);
         case '%':
             advance();
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::MODULO_EQ, "%=", tmp_l, tmp_c, file_name);
+                return Token(TokenType::MODULO_EQ, "%=", location);
             }
-            return Token(TokenType::MODULO, "%", tmp_l, tmp_c, file_name);
+            return Token(TokenType::MODULO, "%", location);
         case '=':
             advance();
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::EQ_EQ, "==", tmp_l, tmp_c, file_name);
+                return Token(TokenType::EQ_EQ, "==", location);
             }
-            return Token(TokenType::EQ, "=", tmp_l, tmp_c, file_name);
+            return Token(TokenType::EQ, "=", location);
         case '!':
             advance();
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::NOT_EQ, "!=", tmp_l, tmp_c, file_name);
+                return Token(TokenType::NOT_EQ, "!=", location);
             }
-            return Token(TokenType::L_NOT, "!", tmp_l, tmp_c, file_name);
+            return Token(TokenType::L_NOT, "!", location);
         case '~':
             advance();
-            return Token(TokenType::B_NOT, "~", tmp_l, tmp_c, file_name);
+            return Token(TokenType::B_NOT, "~", location);
         case '>':
             advance();
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::GT_EQ, ">=", tmp_l, tmp_c, file_name);
+                return Token(TokenType::GT_EQ, ">=", location);
             }
             else if (peek() == '>') {
                 advance();
-                return Token(TokenType::R_SHIFT, ">>", tmp_l, tmp_c, file_name);
+                return Token(TokenType::R_SHIFT, ">>", location);
             }
-            return Token(TokenType::GT, ">", tmp_l, tmp_c, file_name);
+            return Token(TokenType::GT, ">", location);
         case '<':
             advance();
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::LS_EQ, "<=", tmp_l, tmp_c, file_name);
+                return Token(TokenType::LS_EQ, "<=", location);
             }
             else if (peek() == '<') {
                 advance();
-                return Token(TokenType::L_SHIFT, "<<", tmp_l, tmp_c, file_name);
+                return Token(TokenType::L_SHIFT, "<<", location);
             }
-            return Token(TokenType::LS, "<", tmp_l, tmp_c, file_name);
+            return Token(TokenType::LS, "<", location);
         case '&':
             advance();
             if (peek() == '&') {
                 advance();
-                return Token(TokenType::L_AND, "&&", tmp_l, tmp_c, file_name);
+                return Token(TokenType::L_AND, "&&", location);
             }
-            return Token(TokenType::B_AND, "&", tmp_l, tmp_c, file_name);
+            return Token(TokenType::B_AND, "&", location);
         case '|':
             advance();
             if (peek() == '|') {
                 advance();
-                return Token(TokenType::L_OR, "||", tmp_l, tmp_c, file_name);
+                return Token(TokenType::L_OR, "||", location);
             }
-            return Token(TokenType::B_OR, "|", tmp_l, tmp_c, file_name);
+            return Token(TokenType::B_OR, "|", location);
         case '^':
             advance();
-            return Token(TokenType::B_XOR, "^", tmp_l, tmp_c, file_name);
+            return Token(TokenType::B_XOR, "^", location);
         default:
-            throw_error(file_name, LEXER, "Unsupported operator: '" + std::string{1, c} + "' (" + std::to_string(line) + ':' + std::to_string(column) + ")\n", line);
+            throw_error(location, LEXER, "Unsupported operator: '" + std::string{1, c} + "'\n");
     }
 }
 
 void Lexer::skip_singleline_comment() {
-    while (peek() != '\n') {
+    advance_to(scan_line_end(source.data() + pos) - source.data());
+    if (pos < source_len) {
         advance();
     }
-    advance();
 }
 
 void Lexer::skip_multiline_comment() {
+    SourceLocation location = get_location();
     advance();
     advance();
-    while (peek() != '/' || peek(-1) != '*') {
-        advance();
+    // the closing '/' can be the second byte of the body at the earliest: in "/*/" the '*' before it is the opening one
+    if (pos < source_len) {
+        advance_to(scan_comment_end(source.data() + pos + 1) - source.data());
+    }
+    if (pos >= source_len) {
+        throw_error(location, LEXER, "Unterminated comment\n");
     }
     advance();
 }
 
+void Lexer::skip_quoted(char quote, SourceLocation start_location) {
+    while (true) {
+        advance_to(scan_quote(source.data() + pos, quote) - source.data());
+        if (pos >= source_len) {
+            throw_error(start_location, LEXER, "Unterminated literal\n");
+        }
+        if (peek() != '\\') {
+            return;
+        }
+        advance();
+        skip_escape_sequence();
+    }
+}
+
 void Lexer::handle_preprocessor() {
     while (peek() == ' ') {
         advance();
     }
     std::string directive_name;
-    while (peek() != ' ') {
+    while (peek() != ' ' && peek() != '\n' && peek() != '\0') {
         directive_name += advance();
     }
     if (directive_name == "include") {
         handle_preprocessor_include();
     }
     else {
-        throw_error(file_name, LEXER, "Unsupported preprocessor directive: '" + directive_name + "' (" + std::to_string(line) + ':' + std::to_string(column) + ")\n", line);
+        throw_error(get_location(), LEXER, "Unsupported preprocessor directive: '" + directive_name + "'\n");
     }
 }
 
@@ -328,82 +549,105 @@ void Lexer::handle_preprocessor_include() {
         advance();
     }
     if (peek() != '<') {
-        throw_error(file_name, LEXER, "Use: 'include <include_name>' (" + std::to_string(line) + ':' + std::to_string(column) + ")\n", line);
+        throw_error(get_location(), LEXER, "Use: 'include <include_name>'\n");
     }
     advance();
-    int tmp_l = line;
-    int tmp_c = column;
+    SourceLocation location = get_location();
     std::string include_file_name;
-    while (peek() != '\n' && peek() != '>') {
+    while (peek() != '\n' && peek() != '>' && peek() != '\0') {
         include_file_name += advance();
     }
     include_file_name += ".bl";
     if (peek() != '>') {
-        throw_error(file_name, LEXER, "Use: 'include <include_name>' (" + std::to_string(line) + ':' + std::to_string(column) + ")\n", line);
+        throw_error(get_location(), LEXER, "Use: 'include <include_name>'\n");
     }
     advance();
 
-    std::filesystem::path absolute_current_file_path(this->file_name);
+    std::filesystem::path absolute_current_file_path(SourceManager::get_path(file_id));
     std::string absolute_include_file_path = absolute_current_file_path.parent_path().string() + '/' + include_file_name;
-    if (std::find(Lexer::included_files_paths.begin(), Lexer::included_files_paths.end(), absolute_include_file_path) != Lexer::included_files_paths.end()) {
+    if (SourceManager::find_file(absolute_include_file_path)) {
         return;
     }
-    std::ifstream file(absolute_include_file_path);
-    if (!file.is_open()) {
-        throw_error(file_name, LEXER, "File '" + include_file_name + "' in '" + absolute_current_file_path.parent_path().string() + "/' does not exist (" + std::to_string(tmp_l) + ':' + std::to_string(tmp_c) + ")\n", tmp_l);
-    }
-    Lexer::included_files_paths.push_back(absolute_include_file_path);
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    Lexer include_lexer(content, absolute_include_file_path);
-    std::vector<Token> include_tokens = include_lexer.tokenize();
-    unsigned include_tokens_size = include_tokens.size();
-    for (unsigned i = 0; i < include_tokens_size; i++) {
-        tokens.push_back(include_tokens[i]);
+    std::optional<std::uint32_t> include_file_id = SourceManager::load_file(absolute_include_file_path);
+    if (!include_file_id) {
+        throw_error(location, LEXER, "File '" + include_file_name + "' in '" + absolute_current_file_path.parent_path().string() + "/' does not exist\n");
     }
+    include_lexer = std::make_unique<Lexer>(*include_file_id);
 }
 
-const char Lexer::advance_escape_sequence() {
+void Lexer::skip_escape_sequence() {
     const char c = advance();
+    char value;
+    if (!get_escape_sequence_value(c, value)) {
+        throw_error(get_location() - 2, LEXER, "Unsupported escape-sequence: '\\" + std::string{1, c} + "'\n");
+    }
+}
+
+// The source is padded with zero bytes (see `SOURCE_PADDING`), so looking a few bytes past the end is safe and yields '\0'
+const char Lexer::peek(int rpos) {
+    return source.data()[pos + rpos];
+}
+
+const char Lexer::advance() {
+    return source.data()[pos++];
+}
+
+void Lexer::advance_to(unsigned long new_pos) {
+    pos = new_pos;
+}
+
+SourceLocation Lexer::get_location() const {
+    return base_location + pos;
+}
+
+bool get_escape_sequence_value(char c, char& value) {
     switch (c) {
         case 'n':
-            return '\n';
+            value = '\n';
+            return true;
         case 't':
-            return '\t';
+            value = '\t';
+            return true;
         case '\\':
-            return '\\';
+            value = '\\';
+            return true;
         case '\"':
-            return '\"';
+            value = '\"';
+            return true;
         case '\'':
-            return '\'';
+            value = '\'';
+            return true;
         case 'a':
-            return '\a';
+            value = '\a';
+            return true;
         case 'b':
-            return '\b';
+            value = '\b';
+            return true;
         case 'r':
-            return '\r';
+            value = '\r';
+            return true;
         case 'f':
-            return '\f';
+            value = '\f';
+            return true;
         case 'v':
-            return '\v';
+            value = '\v';
+            return true;
         default:
-            throw_error(file_name, LEXER, "Unsupported escape-sequence: '\\" + std::string{1, c} + "' (" + std::to_string(line) + ':' + std::to_string(column - 2) + ")\n", line);
+            return false;
     }
 }
 
-const char Lexer::peek(int rpos) {
-    if (pos + rpos >= source_len) {
-        throw_error(file_name, LEXER, "Index out of range: (" + std::to_string(pos + rpos) + "/" + std::to_string(source_len) + ")\n", line);
-    }
-    return source[pos + rpos];
-}
-
-const char Lexer::advance() {
-    const char c = peek();
-    column++;
-    pos++;
-    if (c == '\n') {
-        line++;
-        column = 1;
+// String and char tokens view the raw source text, the lexer has already validated every escape-sequence in it
+std::string unescape_string(std::string_view raw) {
+    std::string result;
+    result.reserve(raw.length());
+    unsigned long raw_len = raw.length();
+    for (unsigned long i = 0; i < raw_len; i++) {
+        char c = raw[i];
+        if (c == '\\' && i + 1 < raw_len) {
+            get_escape_sequence_value(raw[++i], c);
+        }
+        result += c;
     }
-    return c;
+    return result;
 }
@@ -0,0 +1,235 @@
+#include "../../include/lexer/scanner.hpp"
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BLINK_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+static bool is_identifier_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static const char* scan_identifier_scalar(const char* p) {
+    while (is_identifier_char(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static const char* scan_whitespace_scalar(const char* p) {
+    while (*p == ' ' || *p == '\n') {
+        p++;
+    }
+    return p;
+}
+
+static const char* scan_line_end_scalar(const char* p) {
+    while (*p != '\n' && *p != '\0') {
+        p++;
+    }
+    return p;
+}
+
+static const char* scan_comment_end_scalar(const char* p) {
+    while (*p != '\0' && (*p != '/' || p[-1] != '*')) {
+        p++;
+    }
+    return p;
+}
+
+static const char* scan_quote_scalar(const char* p, char quote) {
+    while (*p != quote && *p != '\\' && *p != '\0') {
+        p++;
+    }
+    return p;
+}
+
+#if defined(BLINK_SCANNER_X86)
+// Every helper returns a bitmask with one bit per byte that stops the scan
+static inline unsigned identifier_stop_mask_sse2(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), lower));
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+    __m128i is_underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return ~_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(is_alpha, is_digit), is_underscore)) & 0xFFFF;
+}
+
+static const char* scan_identifier_sse2(const char* p) {
+    while (true) {
+        unsigned mask = identifier_stop_mask_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+}
+
+static const char* scan_whitespace_sse2(const char* p) {
+    while (true) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i is_space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+        unsigned mask = ~_mm_movemask_epi8(is_space) & 0xFFFF;
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+}
+
+static const char* scan_line_end_sse2(const char* p) {
+    while (true) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_setzero_si128())));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+}
+
+static const char* scan_comment_end_sse2(const char* p) {
+    while (true) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p - 1));
+        __m128i is_end = _mm_and_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('/')), _mm_cmpeq_epi8(prev, _mm_set1_epi8('*')));
+        unsigned mask = _mm_movemask_epi8(_mm_or_si128(is_end, _mm_cmpeq_epi8(v, _mm_setzero_si128())));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+}
+
+static const char* scan_quote_sse2(const char* p, char quote) {
+    while (true) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i is_stop = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(quote)), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+        unsigned mask = _mm_movemask_epi8(_mm_or_si128(is_stop, _mm_cmpeq_epi8(v, _mm_setzero_si128())));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+}
+
+__attribute__((target("avx2"))) static inline unsigned identifier_stop_mask_avx2(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i is_alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    __m256i is_underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+    return ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(is_alpha, is_digit), is_underscore)));
+}
+
+__attribute__((target("avx2"))) static const char* scan_identifier_avx2(const char* p) {
+    while (true) {
+        unsigned mask = identifier_stop_mask_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+}
+
+__attribute__((target("avx2"))) static const char* scan_whitespace_avx2(const char* p) {
+    while (true) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i is_space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(is_space));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+}
+
+__attribute__((target("avx2"))) static const char* scan_line_end_avx2(const char* p) {
+    while (true) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i is_stop = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+        unsigned mask = _mm256_movemask_epi8(is_stop);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+}
+
+__attribute__((target("avx2"))) static const char* scan_comment_end_avx2(const char* p) {
+    while (true) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i prev = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p - 1));
+        __m256i is_end = _mm256_and_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')), _mm256_cmpeq_epi8(prev, _mm256_set1_epi8('*')));
+        unsigned mask = _mm256_movemask_epi8(_mm256_or_si256(is_end, _mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+}
+
+__attribute__((target("avx2"))) static const char* scan_quote_avx2(const char* p, char quote) {
+    while (true) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i is_stop = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(quote)), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+        unsigned mask = _mm256_movemask_epi8(_mm256_or_si256(is_stop, _mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+}
+#endif
+
+struct ScannerKernels {
+    const char* isa_name;
+    const char* (*identifier)(const char*);
+    const char* (*whitespace)(const char*);
+    const char* (*line_end)(const char*);
+    const char* (*comment_end)(const char*);
+    const char* (*quote)(const char*, char);
+};
+
+static ScannerKernels select_scanner_kernels() {
+    const char* forced = std::getenv("BLINK_SCANNER");
+    [[maybe_unused]] auto allows = [forced](const char* isa_name) {
+        return forced == nullptr || std::strcmp(forced, isa_name) == 0;
+    };
+    #if defined(BLINK_SCANNER_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && allows("avx2")) {
+        return { "avx2", scan_identifier_avx2, scan_whitespace_avx2, scan_line_end_avx2, scan_comment_end_avx2, scan_quote_avx2 };
+    }
+    if (__builtin_cpu_supports("sse2") && allows("sse2")) {
+        return { "sse2", scan_identifier_sse2, scan_whitespace_sse2, scan_line_end_sse2, scan_comment_end_sse2, scan_quote_sse2 };
+    }
+    #endif
+    return { "scalar", scan_identifier_scalar, scan_whitespace_scalar, scan_line_end_scalar, scan_comment_end_scalar, scan_quote_scalar };
+}
+
+static const ScannerKernels scanner_kernels = select_scanner_kernels();
+
+const char* scan_identifier(const char* p) {
+    return scanner_kernels.identifier(p);
+}
+
+const char* scan_whitespace(const char* p) {
+    return scanner_kernels.whitespace(p);
+}
+
+const char* scan_line_end(const char* p) {
+    return scanner_kernels.line_end(p);
+}
+
+const char* scan_comment_end(const char* p) {
+    return scanner_kernels.comment_end(p);
+}
+
+const char* scan_quote(const char* p, char quote) {
+    return scanner_kernels.quote(p, quote);
+}
+
+const char* get_scanner_isa_name() {
+    return scanner_kernels.isa_name;
+}
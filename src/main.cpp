@@ -3,10 +3,12 @@
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/TargetParser/Triple.h>
+#include <llvm/TargetParser/Host.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/MC/TargetRegistry.h>
+#include <llvm/MC/MCSubtargetInfo.h>
 #include <llvm/IR/GlobalVariable.h>
 #include <llvm/IRReader/IRReader.h>
 #include <llvm/Support/SourceMgr.h>
@@ -15,23 +17,125 @@
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Module.h>
 
+#include "../include/source/source_manager.hpp"
+#include "../include/optimizer/optimizer.hpp"
 #include "../include/semantic/semantic.hpp"
 #include "../include/codegen/codegen.hpp"
 #include "../include/parser/parser.hpp"
 #include "../include/lexer/lexer.hpp"
 #include <filesystem>
+#include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <thread>
 
 std::string token_to_string(Token& token);
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Use: blinkc <source_name>\n";
+    // -stream: lex, parse, check and emit one top-level declaration at a time, so peak memory follows the largest declaration
+    // -j<N>: number of worker threads (defaults to the number of hardware threads)
+    // -symbol-stats: print unique identifiers versus identifier references after compiling
+    // -fold-stats: print what constant folding removed from the AST
+    // -export=<name>[,<name>...]: keep the function even if `main` never calls it
+    // -prune-report: list the functions removed as unreachable from `main` and the exported functions
+    // -O0, -O1, -O2, -O3, -Os, -Oz: LLVM optimization pipeline run before emitting the object file (defaults to -O0)
+    // -march=native: generate code for the host CPU and all of its features; -march=<cpu> and -mcpu=<cpu> pick the CPU by name
+    // -mattr=<+feature,-feature...>: enable or disable target features on top of the CPU ones
+    bool streaming = false;
+    bool symbol_stats = false;
+    bool fold_stats = false;
+    bool folding = true;
+    bool prune_report = false;
+    std::vector<std::string> exported_names;
+    llvm::OptimizationLevel opt_level = llvm::OptimizationLevel::O0;
+    llvm::CodeGenOptLevel codegen_opt_level = llvm::CodeGenOptLevel::None;
+    std::string target_cpu = "generic";
+    std::string target_features;
+    std::string extra_features;
+    unsigned threads_count = std::max(1u, std::thread::hardware_concurrency());
+    std::string source_path;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "-stream") {
+            streaming = true;
+        }
+        else if (arg == "-symbol-stats") {
+            symbol_stats = true;
+        }
+        else if (arg == "-fold-stats") {
+            fold_stats = true;
+        }
+        else if (arg == "-no-fold") {
+            folding = false;
+        }
+        else if (arg == "-prune-report") {
+            prune_report = true;
+        }
+        else if (arg.rfind("-export=", 0) == 0) {
+            std::size_t start = 8;
+            while (start <= arg.length()) {
+                std::size_t end = std::min(arg.find(',', start), arg.length());
+                if (end > start) {
+                    exported_names.push_back(arg.substr(start, end - start));
+                }
+                start = end + 1;
+            }
+        }
+        else if (arg == "-O0") {
+            opt_level = llvm::OptimizationLevel::O0;
+            codegen_opt_level = llvm::CodeGenOptLevel::None;
+        }
+        else if (arg == "-O1") {
+            opt_level = llvm::OptimizationLevel::O1;
+            codegen_opt_level = llvm::CodeGenOptLevel::Less;
+        }
+        else if (arg == "-O2") {
+            opt_level = llvm::OptimizationLevel::O2;
+            codegen_opt_level = llvm::CodeGenOptLevel::Default;
+        }
+        else if (arg == "-O3") {
+            opt_level = llvm::OptimizationLevel::O3;
+            codegen_opt_level = llvm::CodeGenOptLevel::Aggressive;
+        }
+        else if (arg == "-Os") {
+            opt_level = llvm::OptimizationLevel::Os;
+            codegen_opt_level = llvm::CodeGenOptLevel::Default;
+        }
+        else if (arg == "-Oz") {
+            opt_level = llvm::OptimizationLevel::Oz;
+            codegen_opt_level = llvm::CodeGenOptLevel::Default;
+        }
+        else if (arg == "-march=native") {
+            target_cpu = llvm::sys::getHostCPUName().str();
+            target_features.clear();
+            for (const llvm::StringMapEntry<bool>& feature : llvm::sys::getHostCPUFeatures()) {
+                target_features += target_features.empty() ? "" : ",";
+                target_features += (feature.getValue() ? "+" : "-") + feature.getKey().str();
+            }
+        }
+        else if (arg.rfind("-march=", 0) == 0 || arg.rfind("-mcpu=", 0) == 0) {
+            // features detected by an earlier `-march=native` belong to the host CPU, not to this one
+            target_cpu = arg.substr(arg.find('=') + 1);
+            target_features.clear();
+        }
+        else if (arg.rfind("-mattr=", 0) == 0) {
+            extra_features += (extra_features.empty() ? "" : ",") + arg.substr(7);
+        }
+        else if (arg.rfind("-j", 0) == 0 && arg.length() > 2 && std::all_of(arg.begin() + 2, arg.end(), ::isdigit)) {
+            threads_count = std::max(1, std::stoi(arg.substr(2)));
+        }
+        else if (arg[0] != '-' && source_path.empty()) {
+            source_path = arg;
+        }
+        else {
+            source_path.clear();
+            break;
+        }
+    }
+    if (source_path.empty()) {
+        std::cerr << "Use: blinkc [-stream] [-j<N>] [-symbol-stats] [-fold-stats] [-no-fold] [-export=<name>] [-prune-report] [-O<0|1|2|3|s|z>] [-march=native|<cpu>] [-mcpu=<cpu>] [-mattr=<features>] <source_name>\n";
         return 1;
     }
 
-    const std::string source_path = argv[1];
     std::string executable_path = source_path;
     if (executable_path.find('.') != std::string::npos) {
         for (int i = executable_path.size() - 1; executable_path[i] != '.'; i--) {
@@ -53,34 +157,96 @@ int main(int argc, char* argv[]) {
     #endif
     const std::string object_path = executable_path + obj_ext;
     
-    std::ifstream file(argv[1]);
-    if (!file.is_open()) {
+    std::filesystem::path absolute_path = std::filesystem::absolute(source_path);
+    std::optional<std::uint32_t> file_id = SourceManager::load_file(absolute_path.string());
+    if (!file_id) {
         std::cerr << "Error opening file!\n";
         return 1;
     }
-    
-    std::filesystem::path absolute_path = std::filesystem::absolute(argv[1]);
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
 
-    Lexer lexer(content, absolute_path.string());
-    std::vector<Token> tokens = lexer.tokenize();
+    Lexer lexer(*file_id);
+    Arena arena;
+    std::vector<StmtPtr> stmts;
+    SemanticAnalyzer semantic(stmts);
+    ConstantFolder folder(arena);
+    CodeGenerator codegen(source_path, stmts);
+    // later features override earlier ones, so explicit `-mattr` ones win over the detected host features
+    if (!extra_features.empty()) {
+        target_features += (target_features.empty() ? "" : ",") + extra_features;
+    }
+    codegen.set_target(target_cpu, target_features);
+    // unoptimized builds get locals in SSA form right away, optimized ones leave promoting the entry block allocas to the pipeline
+    codegen.set_direct_ssa(opt_level == llvm::OptimizationLevel::O0);
 
-    /* for (Token token : tokens) {
-        std::cout << token_to_string(token) << '\n';
-    } */
+    if (streaming) {
+        std::cout << "CODE ANALYZING AND GENERATING...\n";
 
-    Parser parser(tokens);
-    std::vector<StmtPtr> stmts = parser.parse();
+        Parser parser(lexer, arena);
+        semantic.set_streaming(true);
+        folder.set_streaming(true);
+        codegen.generate_builtins();
+        ArenaMark mark = arena.get_mark();
+        while (StmtPtr stmt = parser.parse_next()) {
+            semantic.analyze_stmt(*stmt);
+            if (folding || stmt->kind == NodeKind::VAR_DECL_STMT) {
+                folder.fold_stmt(*stmt);
+            }
+            codegen.generate_stmt(*stmt);
+            arena.rewind(mark);
+        }
+    }
+    else {
+        std::vector<Token> tokens = lexer.tokenize();
 
-    std::cout << "CODE ANALYZING...\n";
-    SemanticAnalyzer semantic(stmts);
-    semantic.analyze();
-    
-    std::cout << "CODE ANALYZING SUCCESS. CODE GENERATING...\n";
+        /* for (Token token : tokens) {
+            std::cout << token_to_string(token) << '\n';
+        } */
 
-    CodeGenerator codegen(source_path, stmts);
-    codegen.generate();
+        Parser parser(std::move(tokens), arena);
+        stmts = parser.parse_parallel(threads_count);
+
+        std::cout << "CODE ANALYZING...\n";
+        semantic.analyze(threads_count);
+
+        // functions unreachable from `main` and the exported ones never get to LLVM
+        std::vector<Symbol> roots = { Interner::intern("main") };
+        for (const std::string& name : exported_names) {
+            Symbol symbol = Interner::intern(name);
+            if (!semantic.has_function(symbol)) {
+                std::cerr << "Exported function '" << name << "' does not exist\n";
+                return 1;
+            }
+            roots.push_back(symbol);
+        }
+        std::vector<Symbol> pruned = semantic.prune_unreachable_functions(roots);
+        if (prune_report) {
+            std::cout << "Pruned " << pruned.size() << " unreachable functions\n";
+            for (Symbol name : pruned) {
+                std::cout << "  " << Interner::get_name(name) << '\n';
+            }
+        }
+        if (folding) {
+            folder.fold(stmts);
+        }
+        else {
+            folder.fold_globals(stmts);
+        }
+        
+        std::cout << "CODE ANALYZING SUCCESS. CODE GENERATING...\n";
+
+        codegen.generate();
+    }
     codegen.print_ir();
+    if (symbol_stats) {
+        InternerStats stats = Interner::get_stats();
+        std::cout << "Identifiers: " << stats.unique_symbols << " unique (" << stats.unique_bytes << " bytes), " << stats.references << " references ("
+                  << stats.referenced_bytes << " bytes)\n";
+    }
+    if (fold_stats) {
+        FoldStats stats = folder.get_stats();
+        std::cout << "Constant folding: " << stats.folded_exprs << " expressions folded, " << stats.propagated_uses << " constant uses propagated, "
+                  << stats.folded_branches << " branches folded, " << stats.comptime_calls << " calls evaluated, " << stats.eliminated_nodes << " AST nodes eliminated\n";
+    }
     std::unique_ptr<llvm::Module> module = codegen.get_module();
     
     std::cout << "CODE GENERATING SUCESS. COMPILING...\n";
@@ -145,19 +311,40 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    std::string CPU = "generic";
-    std::string features = "";
     llvm::TargetOptions opt;
     auto reloc_model = std::optional<llvm::Reloc::Model>();
-    std::unique_ptr<llvm::TargetMachine> target_machine(target->createTargetMachine(target_triple, CPU, features, opt, reloc_model));
+    std::unique_ptr<llvm::TargetMachine> target_machine(target->createTargetMachine(target_triple, target_cpu, target_features, opt, reloc_model,
+                                                                                    std::nullopt, codegen_opt_level));
     if (!target_machine)
     {
         std::cerr << "Failed to create TargetMachine for triple '" << target_triple << "'" << '\n';
         return 1;
     }
 
+    // LLVM only warns about an unknown CPU and falls back to a generic one
+    if (!target_machine->getMCSubtargetInfo()->isCPUStringValid(target_cpu))
+    {
+        std::cerr << "Unknown CPU '" << target_cpu << "' for target '" << target_triple << "'" << '\n';
+        return 1;
+    }
+
     module->setDataLayout(target_machine->createDataLayout());
 
+    // default module, CGSCC and function pipelines of the new pass manager for the chosen level
+    llvm::LoopAnalysisManager loop_analyses;
+    llvm::FunctionAnalysisManager function_analyses;
+    llvm::CGSCCAnalysisManager cgscc_analyses;
+    llvm::ModuleAnalysisManager module_analyses;
+    llvm::PassBuilder pass_builder(target_machine.get());
+    pass_builder.registerModuleAnalyses(module_analyses);
+    pass_builder.registerCGSCCAnalyses(cgscc_analyses);
+    pass_builder.registerFunctionAnalyses(function_analyses);
+    pass_builder.registerLoopAnalyses(loop_analyses);
+    pass_builder.crossRegisterProxies(loop_analyses, function_analyses, cgscc_analyses, module_analyses);
+    llvm::ModulePassManager optimizer = opt_level == llvm::OptimizationLevel::O0 ? pass_builder.buildO0DefaultPipeline(opt_level)
+                                                                                 : pass_builder.buildPerModuleDefaultPipeline(opt_level);
+    optimizer.run(*module, module_analyses);
+
     std::error_code ec;
     llvm::raw_fd_ostream dest(object_path, ec, llvm::sys::fs::OF_None);
     if (ec)
@@ -225,5 +412,5 @@ int main(int argc, char* argv[]) {
 }
 
 std::string token_to_string(Token& token) {
-    return "'" + std::to_string((int)token.type) + "' : '" + token.value + "' (" + std::to_string(token.line) + ":" + std::to_string(token.column) + ")";
+    return "'" + std::to_string((int)token.type) + "' : '" + std::string(token.value) + "' (" + std::to_string(token.location) + ")";
 }
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include "../../include/optimizer/constant.hpp"
+#include <type_traits>
+#include <cmath>
+
+static unsigned get_bit_width(TypeValue base) {
+    switch (base) {
+        case TypeValue::BOOL:
+            return 1;
+        case TypeValue::I8:
+        case TypeValue::U8:
+            return 8;
+        case TypeValue::I16:
+        case TypeValue::U16:
+            return 16;
+        case TypeValue::I32:
+        case TypeValue::U32:
+            return 32;
+        default:
+            return 64;
+    }
+}
+
+// Only numbers and `bool`s are folded, strings and pointers are left to `CodeGenerator`
+static bool is_foldable(const TypeInfo& info) {
+    return info.pointer_depth == 0 && info.base <= TypeValue::U64;
+}
+
+static bool is_unsigned_int(const TypeInfo& info) {
+    return info.is_unsigned() || info.base == TypeValue::BOOL;
+}
+
+// Wraps `bits` to the width of the type and extends them back to 64 bits the way the type is signed
+static std::uint64_t normalize(std::uint64_t bits, const TypeInfo& info) {
+    unsigned width = get_bit_width(info.base);
+    if (width == 64) {
+        return bits;
+    }
+    std::uint64_t mask = (1ull << width) - 1;
+    bits &= mask;
+    if (!is_unsigned_int(info) && (bits >> (width - 1) & 1)) {
+        bits |= ~mask;
+    }
+    return bits;
+}
+
+template<typename F>
+static bool evaluate_float_binary(TokenType op_type, F left, F right, std::uint64_t& bits, double& number) {
+    switch (op_type) {
+        case TokenType::PLUS:
+            number = left + right;
+            return true;
+        case TokenType::MINUS:
+            number = left - right;
+            return true;
+        case TokenType::MULT:
+            number = left * right;
+            return true;
+        case TokenType::DIV:
+            number = left / right;
+            return true;
+        case TokenType::MODULO:
+            number = std::fmod(left, right);
+            return true;
+        case TokenType::GT:
+            bits = left > right;
+            return true;
+        case TokenType::GT_EQ:
+            bits = left >= right;
+            return true;
+        case TokenType::LS:
+            bits = left < right;
+            return true;
+        case TokenType::LS_EQ:
+            bits = left <= right;
+            return true;
+        case TokenType::EQ_EQ:
+            bits = left == right;
+            return true;
+        case TokenType::NOT_EQ:
+            bits = left < right || left > right;    // ordered comparison, false for NaN
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_foldable_type(TypeId type) {
+    return is_foldable(TypeContext::get_info(type));
+}
+
+bool read_constant(const Value& value, Constant& constant) {
+    return std::visit([&](auto v) {
+        using T = decltype(v);
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            return false;
+        }
+        else {
+            if constexpr (std::is_floating_point_v<T>) {
+                constant.number = v;
+            }
+            else if constexpr (std::is_same_v<T, bool> || std::is_unsigned_v<T>) {
+                constant.bits = v;
+            }
+            else {
+                constant.bits = static_cast<std::int64_t>(v);
+            }
+            return true;
+        }
+    }, value.value);
+}
+
+Value make_constant_value(Constant constant, TypeId type) {
+    Value value(false);
+    switch (TypeContext::get_info(type).base) {
+        case TypeValue::BOOL:
+            value = Value(constant.bits != 0);
+            break;
+        case TypeValue::I8:
+            value = Value(static_cast<std::int8_t>(constant.bits));
+            break;
+        case TypeValue::I16:
+            value = Value(static_cast<std::int16_t>(constant.bits));
+            break;
+        case TypeValue::I32:
+            value = Value(static_cast<std::int32_t>(constant.bits));
+            break;
+        case TypeValue::I64:
+            value = Value(static_cast<std::int64_t>(constant.bits));
+            break;
+        case TypeValue::F32:
+            value = Value(static_cast<std::float_t>(constant.number));
+            break;
+        case TypeValue::F64:
+            value = Value(static_cast<std::double_t>(constant.number));
+            break;
+        case TypeValue::U8:
+            value = Value(static_cast<std::uint8_t>(constant.bits));
+            break;
+        case TypeValue::U16:
+            value = Value(static_cast<std::uint16_t>(constant.bits));
+            break;
+        case TypeValue::U32:
+            value = Value(static_cast<std::uint32_t>(constant.bits));
+            break;
+        case TypeValue::U64:
+            value = Value(static_cast<std::uint64_t>(constant.bits));
+            break;
+        default: {}
+    }
+    return value;
+}
+
+bool evaluate_binary(TokenType op_type, TypeId operands_type, TypeId result_type, Constant left, Constant right, Constant& result) {
+    const TypeInfo& info = TypeContext::get_info(operands_type);
+    if (info.is_float()) {
+        if (info.base == TypeValue::F32) {
+            return evaluate_float_binary<float>(op_type, left.number, right.number, result.bits, result.number);
+        }
+        return evaluate_float_binary<double>(op_type, left.number, right.number, result.bits, result.number);
+    }
+
+    unsigned width = get_bit_width(info.base);
+    bool is_unsigned = is_unsigned_int(info);
+    std::uint64_t a = left.bits;
+    std::uint64_t b = right.bits;
+    std::int64_t signed_a = a;
+    std::int64_t signed_b = b;
+    std::uint64_t bits;
+    switch (op_type) {
+        case TokenType::PLUS:
+            bits = a + b;
+            break;
+        case TokenType::MINUS:
+            bits = a - b;
+            break;
+        case TokenType::MULT:
+            bits = a * b;
+            break;
+        case TokenType::DIV:
+        case TokenType::MODULO:
+            if (b == 0 || (!is_unsigned && signed_b == -1 && a == normalize(1ull << (width - 1), info))) {
+                return false;
+            }
+            if (op_type == TokenType::DIV) {
+                bits = is_unsigned ? a / b : signed_a / signed_b;
+            }
+            else {
+                bits = is_unsigned ? a % b : signed_a % signed_b;
+            }
+            break;
+        case TokenType::GT:
+            bits = is_unsigned ? a > b : signed_a > signed_b;
+            break;
+        case TokenType::GT_EQ:
+            bits = is_unsigned ? a >= b : signed_a >= signed_b;
+            break;
+        case TokenType::LS:
+            bits = is_unsigned ? a < b : signed_a < signed_b;
+            break;
+        case TokenType::LS_EQ:
+            bits = is_unsigned ? a <= b : signed_a <= signed_b;
+            break;
+        case TokenType::EQ_EQ:
+            bits = a == b;
+            break;
+        case TokenType::NOT_EQ:
+            bits = a != b;
+            break;
+        case TokenType::L_AND:
+            bits = a != 0 && b != 0;
+            break;
+        case TokenType::L_OR:
+            bits = a != 0 || b != 0;
+            break;
+        case TokenType::B_AND:
+            bits = a & b;
+            break;
+        case TokenType::B_OR:
+            bits = a | b;
+            break;
+        case TokenType::B_XOR:
+            bits = a ^ b;
+            break;
+        case TokenType::L_SHIFT:
+            if (b >= width) {
+                return false;
+            }
+            bits = a << b;
+            break;
+        case TokenType::R_SHIFT:
+            if (b >= width) {
+                return false;
+            }
+            bits = is_unsigned ? a >> b : signed_a >> b;
+            break;
+        default:
+            return false;
+    }
+    result.bits = normalize(bits, TypeContext::get_info(result_type));
+    return true;
+}
+
+bool evaluate_unary(TokenType op_type, TypeId operand_type, Constant value, Constant& result) {
+    const TypeInfo& info = TypeContext::get_info(operand_type);
+    switch (op_type) {
+        case TokenType::MINUS:
+            if (info.is_float()) {
+                result.number = -value.number;
+            }
+            else {
+                result.bits = normalize(0 - value.bits, info);
+            }
+            return true;
+        case TokenType::L_NOT:
+            result.bits = info.is_float() ? value.number == 0.0 : value.bits == 0;
+            return true;
+        case TokenType::B_NOT:
+            result.bits = normalize(~value.bits, info);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Mirrors `CodeGenerator::convert`
+bool evaluate_conversion(Constant value, TypeId from, TypeId to, Constant& result) {
+    const TypeInfo& from_info = TypeContext::get_info(from);
+    const TypeInfo& to_info = TypeContext::get_info(to);
+    if (!is_foldable(from_info) || !is_foldable(to_info)) {
+        return false;
+    }
+
+    if (to_info.base == TypeValue::BOOL) {
+        result.bits = from_info.is_float() ? value.number != 0.0 : value.bits != 0;
+    }
+    else if (!from_info.is_float() && !to_info.is_float()) {
+        result.bits = normalize(value.bits, to_info);
+    }
+    else if (!from_info.is_float()) {
+        if (to_info.base == TypeValue::F32) {
+            result.number = is_unsigned_int(from_info) ? static_cast<float>(value.bits) : static_cast<float>(static_cast<std::int64_t>(value.bits));
+        }
+        else {
+            result.number = is_unsigned_int(from_info) ? static_cast<double>(value.bits) : static_cast<double>(static_cast<std::int64_t>(value.bits));
+        }
+    }
+    else if (!to_info.is_float()) {
+        // out-of-range conversions are poison in LLVM, they are left to run time
+        double truncated = std::trunc(value.number);
+        unsigned width = get_bit_width(to_info.base);
+        if (is_unsigned_int(to_info)) {
+            if (!(truncated >= 0.0 && truncated < std::ldexp(1.0, width))) {
+                return false;
+            }
+            result.bits = static_cast<std::uint64_t>(truncated);
+        }
+        else {
+            if (!(truncated >= -std::ldexp(1.0, width - 1) && truncated < std::ldexp(1.0, width - 1))) {
+                return false;
+            }
+            result.bits = normalize(static_cast<std::int64_t>(truncated), to_info);
+        }
+    }
+    else {
+        result.number = to_info.base == TypeValue::F32 ? static_cast<float>(value.number) : value.number;
+    }
+    return true;
+}
@@ -0,0 +1,270 @@
+#include "../../include/optimizer/interpreter.hpp"
+
+void Interpreter::add_function(const FuncDeclStmt& fds) {
+    if (fds.function_id >= functions.size()) {
+        functions.resize(fds.function_id + 1, nullptr);
+    }
+    functions[fds.function_id] = &fds;
+}
+
+bool Interpreter::call(std::uint32_t function_id, const std::vector<Constant>& args, Constant& result) {
+    steps_left = STEPS_BUDGET;
+    calls_depth = 0;
+    return invoke(function_id, args, result);
+}
+
+bool Interpreter::invoke(std::uint32_t function_id, const std::vector<Constant>& args, Constant& result) {
+    if (function_id >= functions.size() || functions[function_id] == nullptr || calls_depth == MAX_CALLS_DEPTH) {
+        return false;
+    }
+    const FuncDeclStmt& fds = *functions[function_id];
+
+    Frame callee{};
+    for (std::size_t i = 0; i < args.size(); i++) {
+        callee.variables.emplace_back(fds.args[i].variable_id, args[i]);
+    }
+    Frame* caller = frame;
+    frame = &callee;
+    calls_depth++;
+    Flow flow = execute_block(fds.block);
+    calls_depth--;
+    frame = caller;
+
+    if (flow == Flow::RETURN || (flow == Flow::NEXT && TypeContext::get_info(fds.return_type).base == TypeValue::NOTHING)) {
+        result = callee.return_value;
+        return true;
+    }
+    return false;
+}
+
+Interpreter::Flow Interpreter::execute_block(ArenaSpan<StmtPtr> block) {
+    for (StmtPtr stmt : block) {
+        Flow flow = execute_stmt(*stmt);
+        if (flow != Flow::NEXT) {
+            return flow;
+        }
+    }
+    return Flow::NEXT;
+}
+
+Interpreter::Flow Interpreter::execute_stmt(const Stmt& stmt) {
+    if (steps_left == 0) {
+        return Flow::FAIL;
+    }
+    steps_left--;
+
+    switch (stmt.kind) {
+        case NodeKind::VAR_DECL_STMT: {
+            const VarDeclStmt& vds = static_cast<const VarDeclStmt&>(stmt);
+            Constant value{ 0, 0.0 };
+            if (!is_foldable_type(vds.type) || (vds.expr != nullptr && !evaluate(*vds.expr, value))) {
+                return Flow::FAIL;
+            }
+            set_variable(vds.variable_id, value);
+            return Flow::NEXT;
+        }
+        case NodeKind::FUNC_CALL_STMT: {
+            const FuncCallStmt& fcs = static_cast<const FuncCallStmt&>(stmt);
+            Constant ignored;
+            return evaluate_call(fcs.function_id, fcs.args, ignored) ? Flow::NEXT : Flow::FAIL;
+        }
+        case NodeKind::VAR_ASGN_STMT: {
+            const VarAsgnStmt& vas = static_cast<const VarAsgnStmt&>(stmt);
+            Constant* variable = find_variable(vas.variable_id);     // globals are never written
+            if (variable == nullptr || !evaluate(*vas.expr, *variable)) {
+                return Flow::FAIL;
+            }
+            return Flow::NEXT;
+        }
+        case NodeKind::IF_STMT: {
+            const IfStmt& is = static_cast<const IfStmt&>(stmt);
+            Constant condition;
+            if (!evaluate(*is.condition, condition)) {
+                return Flow::FAIL;
+            }
+            return execute_block(condition.bits != 0 ? is.true_block : is.false_block);
+        }
+        case NodeKind::FOR_CYCLE_STMT: {
+            const ForCycleStmt& fcs = static_cast<const ForCycleStmt&>(stmt);
+            if (execute_stmt(*fcs.indexator) != Flow::NEXT) {
+                return Flow::FAIL;
+            }
+            return execute_loop(fcs.condition, fcs.block, fcs.iteration, true);
+        }
+        case NodeKind::WHILE_CYCLE_STMT: {
+            const WhileCycleStmt& wcs = static_cast<const WhileCycleStmt&>(stmt);
+            return execute_loop(wcs.condition, wcs.block, nullptr, true);
+        }
+        case NodeKind::DO_WHILE_CYCLE_STMT: {
+            const DoWhileCycleStmt& dwcs = static_cast<const DoWhileCycleStmt&>(stmt);
+            return execute_loop(dwcs.condition, dwcs.block, nullptr, false);
+        }
+        case NodeKind::BREAK_STMT:
+            return Flow::BREAK;
+        case NodeKind::CONTINUE_STMT:
+            return Flow::CONTINUE;
+        case NodeKind::RETURN_STMT: {
+            const ReturnStmt& rs = static_cast<const ReturnStmt&>(stmt);
+            if (rs.expr != nullptr && !evaluate(*rs.expr, frame->return_value)) {
+                return Flow::FAIL;
+            }
+            return Flow::RETURN;
+        }
+        default:
+            return Flow::FAIL;
+    }
+}
+
+// `for` and `while` check the condition before every iteration, `do while` after it
+Interpreter::Flow Interpreter::execute_loop(const Expr* condition, ArenaSpan<StmtPtr> block, const Stmt* iteration, bool check_first) {
+    while (1) {
+        if (check_first) {
+            Constant value;
+            if (!evaluate(*condition, value)) {
+                return Flow::FAIL;
+            }
+            if (value.bits == 0) {
+                return Flow::NEXT;
+            }
+        }
+        check_first = true;
+
+        Flow flow = execute_block(block);
+        if (flow == Flow::BREAK) {
+            return Flow::NEXT;
+        }
+        if (flow == Flow::RETURN || flow == Flow::FAIL) {
+            return flow;
+        }
+        if (iteration != nullptr && execute_stmt(*iteration) != Flow::NEXT) {
+            return Flow::FAIL;
+        }
+    }
+}
+
+// Value of `root` after the conversion recorded by `SemanticAnalyzer`. A post-order walk over `pending_exprs` that keeps operand values
+// on `operands`, so operator chains of any length can be evaluated. Calls evaluate their arguments with walks of their own, stacked on top
+bool Interpreter::evaluate(const Expr& root, Constant& value) {
+    std::size_t base = pending_exprs.size();
+    std::size_t operands_base = operands.size();
+    bool ok = true;
+    pending_exprs.push_back({ &root, 0 });
+    while (pending_exprs.size() > base) {
+        const Expr& expr = *pending_exprs.back().expr;
+        unsigned char stage = pending_exprs.back().stage;
+        if (stage == 0) {
+            if (steps_left == 0 || !is_foldable_type(expr.type)) {
+                ok = false;
+                break;
+            }
+            steps_left--;
+            if (expr.kind == NodeKind::BINARY_EXPR || expr.kind == NodeKind::UNARY_EXPR) {
+                pending_exprs.back().stage = 1;
+                const Expr* operand = expr.kind == NodeKind::BINARY_EXPR ? static_cast<const BinaryExpr&>(expr).left
+                                                                         : static_cast<const UnaryExpr&>(expr).expr;
+                pending_exprs.push_back({ operand, 0 });
+                continue;
+            }
+        }
+
+        Constant result;
+        switch (expr.kind) {
+            case NodeKind::LITERAL:
+                ok = read_constant(static_cast<const Literal&>(expr).value, result);
+                break;
+            case NodeKind::BINARY_EXPR: {
+                const BinaryExpr& be = static_cast<const BinaryExpr&>(expr);
+                // the right operand is pushed only once the left one does not decide the result
+                if (stage == 1) {
+                    Constant left = operands.back();
+                    if ((be.op_type == TokenType::L_AND && left.bits == 0) || (be.op_type == TokenType::L_OR && left.bits != 0)) {
+                        operands.pop_back();
+                        result = left;      // short-circuit, as `CodeGenerator` emits it
+                        break;
+                    }
+                    pending_exprs.back().stage = 2;
+                    pending_exprs.push_back({ be.right, 0 });
+                    continue;
+                }
+                Constant right = operands.back();
+                operands.pop_back();
+                Constant left = operands.back();
+                operands.pop_back();
+                ok = evaluate_binary(be.op_type, be.left->converted_type, be.type, left, right, result);
+                break;
+            }
+            case NodeKind::UNARY_EXPR: {
+                const UnaryExpr& ue = static_cast<const UnaryExpr&>(expr);
+                Constant operand = operands.back();
+                operands.pop_back();
+                ok = evaluate_unary(ue.op_type, ue.expr->converted_type, operand, result);
+                break;
+            }
+            case NodeKind::VAR_EXPR: {
+                std::uint32_t variable_id = static_cast<const VarExpr&>(expr).variable_id;
+                if (Constant* variable = find_variable(variable_id)) {
+                    result = *variable;
+                }
+                else {
+                    ok = variable_id < globals.size() && globals[variable_id] && read_constant(*globals[variable_id], result);
+                }
+                break;
+            }
+            case NodeKind::FUNC_CALL_EXPR: {
+                const FuncCallExpr& fce = static_cast<const FuncCallExpr&>(expr);
+                ok = evaluate_call(fce.function_id, fce.args, result);
+                break;
+            }
+            default:
+                ok = false;
+        }
+        if (!ok) {
+            break;
+        }
+        pending_exprs.pop_back();
+
+        Constant converted = result;
+        if (expr.converted_type != expr.type && !evaluate_conversion(result, expr.type, expr.converted_type, converted)) {
+            ok = false;
+            break;
+        }
+        operands.push_back(converted);
+    }
+
+    if (ok) {
+        value = operands.back();
+    }
+    pending_exprs.resize(base);
+    operands.resize(operands_base);
+    return ok;
+}
+
+bool Interpreter::evaluate_call(std::uint32_t function_id, ArenaSpan<ExprPtr> args, Constant& result) {
+    std::vector<Constant> values;
+    for (ExprPtr arg : args) {
+        Constant value;
+        if (!evaluate(*arg, value)) {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return invoke(function_id, values, result);
+}
+
+Constant* Interpreter::find_variable(std::uint32_t variable_id) {
+    for (auto& [id, value] : frame->variables) {
+        if (id == variable_id) {
+            return &value;
+        }
+    }
+    return nullptr;
+}
+
+void Interpreter::set_variable(std::uint32_t variable_id, Constant value) {
+    if (Constant* variable = find_variable(variable_id)) {
+        *variable = value;
+    }
+    else {
+        frame->variables.emplace_back(variable_id, value);
+    }
+}
@@ -0,0 +1,436 @@
+#include "../../include/optimizer/optimizer.hpp"
+#include "../../include/exception/exception.hpp"
+
+static bool is_terminator(const Stmt& stmt) {
+    return stmt.kind == NodeKind::RETURN_STMT || stmt.kind == NodeKind::BREAK_STMT || stmt.kind == NodeKind::CONTINUE_STMT;
+}
+
+static bool has_call(const Expr& root) {
+    std::vector<const Expr*> pending = { &root };
+    while (!pending.empty()) {
+        const Expr& expr = *pending.back();
+        pending.pop_back();
+        switch (expr.kind) {
+            case NodeKind::BINARY_EXPR:
+                pending.push_back(static_cast<const BinaryExpr&>(expr).left);
+                pending.push_back(static_cast<const BinaryExpr&>(expr).right);
+                break;
+            case NodeKind::UNARY_EXPR:
+                pending.push_back(static_cast<const UnaryExpr&>(expr).expr);
+                break;
+            case NodeKind::FUNC_CALL_EXPR:
+                return true;
+            default: {}
+        }
+    }
+    return false;
+}
+
+// Top-level declarations are folded in the order `CodeGenerator` emits them: globals first, so functions see the constant ones
+void ConstantFolder::fold(std::vector<StmtPtr>& stmts) {
+    fold_globals(stmts);
+    for (StmtPtr stmt : stmts) {
+        if (stmt->kind != NodeKind::VAR_DECL_STMT) {
+            fold_stmt(*stmt);
+        }
+    }
+}
+
+// Globals only, which are initialized at compile time and so have to be folded even when nothing else is. Functions are handed to
+// `Interpreter` only here, in streaming mode the AST of earlier declarations is already freed
+void ConstantFolder::fold_globals(std::vector<StmtPtr>& stmts) {
+    for (StmtPtr stmt : stmts) {
+        if (stmt->kind == NodeKind::FUNC_DECL_STMT) {
+            interpreter.add_function(static_cast<const FuncDeclStmt&>(*stmt));
+        }
+    }
+    for (StmtPtr stmt : stmts) {
+        if (stmt->kind == NodeKind::VAR_DECL_STMT) {
+            fold_stmt(*stmt);
+        }
+    }
+}
+
+void ConstantFolder::fold_stmt(Stmt& stmt) {
+    switch (stmt.kind) {
+        case NodeKind::VAR_DECL_STMT:
+            fold_var_decl_stmt(static_cast<VarDeclStmt&>(stmt));
+            break;
+        case NodeKind::FUNC_DECL_STMT: {
+            FuncDeclStmt& fds = static_cast<FuncDeclStmt&>(stmt);
+            in_function = true;
+            for (const Argument& arg : fds.args) {
+                set_constant(arg.variable_id, std::nullopt);
+            }
+            fold_block(fds.block);
+            in_function = false;
+            break;
+        }
+        case NodeKind::FUNC_CALL_STMT:
+            fold_args(static_cast<FuncCallStmt&>(stmt).args);
+            break;
+        case NodeKind::VAR_ASGN_STMT:
+            fold_expr(static_cast<VarAsgnStmt&>(stmt).expr);
+            break;
+        case NodeKind::IF_STMT: {
+            IfStmt& is = static_cast<IfStmt&>(stmt);
+            fold_expr(is.condition);
+            fold_block(is.true_block);
+            fold_block(is.false_block);
+            break;
+        }
+        case NodeKind::FOR_CYCLE_STMT: {
+            ForCycleStmt& fcs = static_cast<ForCycleStmt&>(stmt);
+            fold_stmt(*fcs.indexator);
+            fold_expr(fcs.condition);
+            fold_stmt(*fcs.iteration);
+            fold_block(fcs.block);
+            break;
+        }
+        case NodeKind::WHILE_CYCLE_STMT: {
+            WhileCycleStmt& wcs = static_cast<WhileCycleStmt&>(stmt);
+            fold_expr(wcs.condition);
+            fold_block(wcs.block);
+            break;
+        }
+        case NodeKind::DO_WHILE_CYCLE_STMT: {
+            DoWhileCycleStmt& dwcs = static_cast<DoWhileCycleStmt&>(stmt);
+            fold_block(dwcs.block);
+            fold_expr(dwcs.condition);
+            break;
+        }
+        case NodeKind::RETURN_STMT: {
+            ReturnStmt& rs = static_cast<ReturnStmt&>(stmt);
+            if (rs.expr != nullptr) {
+                fold_expr(rs.expr);
+            }
+            break;
+        }
+        default: {}
+    }
+}
+
+void ConstantFolder::set_streaming(bool enabled) {
+    streaming = enabled;
+}
+
+FoldStats ConstantFolder::get_stats() const {
+    return stats;
+}
+
+// Splices the taken block of constant `if`s into `block`, drops declarations of propagated `const` locals and unreachable statements
+// after `return`, `break` and `continue`
+void ConstantFolder::fold_block(ArenaSpan<StmtPtr>& block) {
+    std::vector<StmtPtr> folded;
+    bool changed = false;
+    auto append = [&](StmtPtr stmt) {
+        if (!folded.empty() && is_terminator(*folded.back())) {
+            stats.eliminated_nodes += count_nodes(*stmt);
+            changed = true;
+            return;
+        }
+        folded.push_back(stmt);
+    };
+
+    for (StmtPtr stmt : block) {
+        if (!folded.empty() && is_terminator(*folded.back())) {
+            append(stmt);
+            continue;
+        }
+        fold_stmt(*stmt);
+
+        if (stmt->kind == NodeKind::IF_STMT) {
+            IfStmt& is = static_cast<IfStmt&>(*stmt);
+            Constant condition;
+            if (get_constant(*is.condition, condition)) {
+                ArenaSpan<StmtPtr> taken = condition.bits != 0 ? is.true_block : is.false_block;
+                unsigned long taken_nodes = 0;
+                for (StmtPtr taken_stmt : taken) {
+                    taken_nodes += count_nodes(*taken_stmt);
+                }
+                stats.eliminated_nodes += count_nodes(is) - taken_nodes;
+                stats.folded_branches++;
+                changed = true;
+                for (StmtPtr taken_stmt : taken) {
+                    append(taken_stmt);
+                }
+                continue;
+            }
+        }
+        else if (stmt->kind == NodeKind::VAR_DECL_STMT) {
+            std::uint32_t variable_id = static_cast<VarDeclStmt&>(*stmt).variable_id;
+            if (variable_id < constants.size() && constants[variable_id]) {
+                stats.eliminated_nodes += count_nodes(*stmt);
+                changed = true;
+                continue;
+            }
+        }
+        append(stmt);
+    }
+
+    if (changed) {
+        block = arena.copy(folded);
+    }
+}
+
+void ConstantFolder::fold_var_decl_stmt(VarDeclStmt& vds) {
+    Constant value;
+    if (vds.expr != nullptr) {
+        bool is_const = TypeContext::get_info(vds.type).is_const;
+        in_const_initializer = is_const;
+        fold_expr(vds.expr);
+        in_const_initializer = false;
+        // a global can not be initialized at run time, so a call `Interpreter` gave up on is an error
+        if (!in_function && has_call(*vds.expr)) {
+            std::string hint = streaming ? " (-stream mode does not keep function bodies to run calls at compile time)" : "";
+            throw_error(vds.location, SEMANTIC, "Initializer of global variable '" + std::string(Interner::get_name(vds.name)) + "' can not be evaluated at compile time"
+                        + hint + '\n');
+        }
+        if (is_const && get_constant(*vds.expr, value)) {
+            set_constant(vds.variable_id, static_cast<Literal&>(*vds.expr).value);
+            return;
+        }
+    }
+    set_constant(vds.variable_id, std::nullopt);
+}
+
+// Folds `root` bottom-up: a post-order walk over `pending_exprs` instead of the call stack, so operator chains of any length can be folded
+void ConstantFolder::fold_expr(ExprPtr& root) {
+    std::size_t base = pending_exprs.size();
+    pending_exprs.push_back({ &root, false });
+    while (pending_exprs.size() > base) {
+        PendingExpr& pending = pending_exprs.back();
+        Expr& expr = **pending.slot;
+        if (!pending.operands_done) {
+            pending.operands_done = true;
+            // operands are pushed last to first, so they are folded in source order
+            switch (expr.kind) {
+                case NodeKind::BINARY_EXPR:
+                    pending_exprs.push_back({ &static_cast<BinaryExpr&>(expr).right, false });
+                    pending_exprs.push_back({ &static_cast<BinaryExpr&>(expr).left, false });
+                    continue;
+                case NodeKind::UNARY_EXPR:
+                    pending_exprs.push_back({ &static_cast<UnaryExpr&>(expr).expr, false });
+                    continue;
+                case NodeKind::FUNC_CALL_EXPR: {
+                    ArenaSpan<ExprPtr> args = static_cast<FuncCallExpr&>(expr).args;
+                    for (std::size_t i = args.size(); i > 0; i--) {
+                        pending_exprs.push_back({ &args[i - 1], false });
+                    }
+                    continue;
+                }
+                default: {}
+            }
+        }
+        ExprPtr* slot = pending.slot;
+        pending_exprs.pop_back();
+        fold_operation(*slot);
+    }
+}
+
+// Replaces `expr`, whose operands are already folded, with a literal if its value (after the conversion recorded by `SemanticAnalyzer`)
+// is known
+void ConstantFolder::fold_operation(ExprPtr& expr) {
+    Constant value;
+    bool is_constant = false;
+    switch (expr->kind) {
+        case NodeKind::LITERAL:
+            is_constant = is_foldable_type(expr->type) && read_constant(static_cast<Literal&>(*expr).value, value);
+            break;
+        case NodeKind::BINARY_EXPR: {
+            BinaryExpr& be = static_cast<BinaryExpr&>(*expr);
+            Constant left;
+            Constant right;
+            if (!get_constant(*be.left, left)) {
+                break;
+            }
+            // the right operand of `&&` and `||` is not evaluated once the left one decides the result
+            if ((be.op_type == TokenType::L_AND && left.bits == 0) || (be.op_type == TokenType::L_OR && left.bits != 0)) {
+                value = left;
+                is_constant = true;
+                break;
+            }
+            is_constant = get_constant(*be.right, right) && evaluate_binary(be.op_type, be.left->converted_type, be.type, left, right, value);
+            break;
+        }
+        case NodeKind::UNARY_EXPR: {
+            UnaryExpr& ue = static_cast<UnaryExpr&>(*expr);
+            Constant operand;
+            is_constant = get_constant(*ue.expr, operand) && evaluate_unary(ue.op_type, ue.expr->converted_type, operand, value);
+            break;
+        }
+        case NodeKind::VAR_EXPR: {
+            std::uint32_t variable_id = static_cast<VarExpr&>(*expr).variable_id;
+            if (variable_id < constants.size() && constants[variable_id]) {
+                is_constant = read_constant(*constants[variable_id], value);
+                stats.propagated_uses++;
+            }
+            break;
+        }
+        case NodeKind::FUNC_CALL_EXPR: {
+            FuncCallExpr& fce = static_cast<FuncCallExpr&>(*expr);
+            if (in_const_initializer && is_foldable_type(fce.type)) {
+                std::vector<Constant> args;
+                Constant arg;
+                for (ExprPtr arg_expr : fce.args) {
+                    if (!get_constant(*arg_expr, arg)) {
+                        break;
+                    }
+                    args.push_back(arg);
+                }
+                if (args.size() == fce.args.size() && interpreter.call(fce.function_id, args, value)) {
+                    is_constant = true;
+                    stats.comptime_calls++;
+                }
+            }
+            break;
+        }
+        default: {}
+    }
+    if (!is_constant) {
+        return;
+    }
+
+    TypeId type = expr->type;
+    Constant converted;
+    if (expr->converted_type != type && evaluate_conversion(value, type, expr->converted_type, converted)) {
+        value = converted;
+        type = expr->converted_type;
+    }
+    if (expr->kind == NodeKind::LITERAL && type == expr->type) {
+        return;
+    }
+    if (expr->kind != NodeKind::VAR_EXPR) {
+        stats.folded_exprs++;
+    }
+    stats.eliminated_nodes += count_nodes(*expr) - 1;
+    expr = make_literal(value, type, *expr);
+}
+
+void ConstantFolder::fold_args(ArenaSpan<ExprPtr> args) {
+    for (ExprPtr& arg : args) {
+        fold_expr(arg);
+    }
+}
+
+ExprPtr ConstantFolder::make_literal(Constant constant, TypeId type, const Expr& replaced) {
+    Literal* literal = arena.make<Literal>(make_constant_value(constant, type), type, replaced.location);
+    literal->converted_type = replaced.converted_type;
+    return literal;
+}
+
+// Value of a literal that is used without a conversion
+bool ConstantFolder::get_constant(const Expr& expr, Constant& constant) const {
+    if (expr.kind != NodeKind::LITERAL || expr.type != expr.converted_type || !is_foldable_type(expr.type)) {
+        return false;
+    }
+    return read_constant(static_cast<const Literal&>(expr).value, constant);
+}
+
+void ConstantFolder::set_constant(std::uint32_t variable_id, std::optional<Value> value) {
+    if (variable_id >= constants.size()) {
+        constants.resize(variable_id + 1);
+    }
+    constants[variable_id] = value;
+    if (!in_function) {
+        if (variable_id >= globals.size()) {
+            globals.resize(variable_id + 1);
+        }
+        globals[variable_id] = value;
+    }
+}
+
+unsigned long ConstantFolder::count_nodes(const Stmt& stmt) const {
+    unsigned long count = 1;
+    auto count_block = [&](ArenaSpan<StmtPtr> block) {
+        for (StmtPtr block_stmt : block) {
+            count += count_nodes(*block_stmt);
+        }
+    };
+    auto count_args = [&](ArenaSpan<ExprPtr> args) {
+        for (ExprPtr arg : args) {
+            count += count_nodes(*arg);
+        }
+    };
+    switch (stmt.kind) {
+        case NodeKind::VAR_DECL_STMT: {
+            const VarDeclStmt& vds = static_cast<const VarDeclStmt&>(stmt);
+            if (vds.expr != nullptr) {
+                count += count_nodes(*vds.expr);
+            }
+            break;
+        }
+        case NodeKind::FUNC_DECL_STMT:
+            count_block(static_cast<const FuncDeclStmt&>(stmt).block);
+            break;
+        case NodeKind::FUNC_CALL_STMT:
+            count_args(static_cast<const FuncCallStmt&>(stmt).args);
+            break;
+        case NodeKind::VAR_ASGN_STMT:
+            count += count_nodes(*static_cast<const VarAsgnStmt&>(stmt).expr);
+            break;
+        case NodeKind::IF_STMT: {
+            const IfStmt& is = static_cast<const IfStmt&>(stmt);
+            count += count_nodes(*is.condition);
+            count_block(is.true_block);
+            count_block(is.false_block);
+            break;
+        }
+        case NodeKind::FOR_CYCLE_STMT: {
+            const ForCycleStmt& fcs = static_cast<const ForCycleStmt&>(stmt);
+            count += count_nodes(*fcs.indexator) + count_nodes(*fcs.condition) + count_nodes(*fcs.iteration);
+            count_block(fcs.block);
+            break;
+        }
+        case NodeKind::WHILE_CYCLE_STMT: {
+            const WhileCycleStmt& wcs = static_cast<const WhileCycleStmt&>(stmt);
+            count += count_nodes(*wcs.condition);
+            count_block(wcs.block);
+            break;
+        }
+        case NodeKind::DO_WHILE_CYCLE_STMT: {
+            const DoWhileCycleStmt& dwcs = static_cast<const DoWhileCycleStmt&>(stmt);
+            count += count_nodes(*dwcs.condition);
+            count_block(dwcs.block);
+            break;
+        }
+        case NodeKind::RETURN_STMT: {
+            const ReturnStmt& rs = static_cast<const ReturnStmt&>(stmt);
+            if (rs.expr != nullptr) {
+                count += count_nodes(*rs.expr);
+            }
+            break;
+        }
+        default: {}
+    }
+    return count;
+}
+
+unsigned long ConstantFolder::count_nodes(const Expr& root) const {
+    if (root.kind != NodeKind::BINARY_EXPR && root.kind != NodeKind::UNARY_EXPR && root.kind != NodeKind::FUNC_CALL_EXPR) {
+        return 1;
+    }
+    unsigned long count = 0;
+    std::vector<const Expr*> pending = { &root };
+    while (!pending.empty()) {
+        const Expr& expr = *pending.back();
+        pending.pop_back();
+        count++;
+        switch (expr.kind) {
+            case NodeKind::BINARY_EXPR:
+                pending.push_back(static_cast<const BinaryExpr&>(expr).left);
+                pending.push_back(static_cast<const BinaryExpr&>(expr).right);
+                break;
+            case NodeKind::UNARY_EXPR:
+                pending.push_back(static_cast<const UnaryExpr&>(expr).expr);
+                break;
+            case NodeKind::FUNC_CALL_EXPR:
+                for (ExprPtr arg : static_cast<const FuncCallExpr&>(expr).args) {
+                    pending.push_back(arg);
+                }
+                break;
+            default: {}
+        }
+    }
+    return count;
+}
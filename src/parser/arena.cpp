@@ -0,0 +1,62 @@
+#include "../../include/parser/arena.hpp"
+#include <cstring>
+
+constexpr std::size_t ARENA_CHUNK_SIZE = 1 << 20;
+
+void* Arena::allocate(std::size_t size, std::size_t alignment) {
+    std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(current) % alignment) % alignment;
+    if (current == nullptr || padding + size > remaining) {
+        // oversized requests get a chunk of their own
+        std::size_t chunk_size = size + alignment > ARENA_CHUNK_SIZE ? size + alignment : ARENA_CHUNK_SIZE;
+        chunks.push_back(std::unique_ptr<char[]>(new char[chunk_size]));
+        current = chunks.back().get();
+        remaining = chunk_size;
+        bytes_reserved += chunk_size;
+        padding = (alignment - reinterpret_cast<std::uintptr_t>(current) % alignment) % alignment;
+    }
+    void* result = current + padding;
+    current += padding + size;
+    remaining -= padding + size;
+    bytes_used += padding + size;
+    return result;
+}
+
+std::string_view Arena::copy_string(std::string_view str) {
+    char* data = static_cast<char*>(allocate(str.length(), 1));
+    std::memcpy(data, str.data(), str.length());
+    return std::string_view(data, str.length());
+}
+
+void Arena::merge(Arena& other) {
+    for (std::unique_ptr<char[]>& chunk : other.chunks) {
+        chunks.push_back(std::move(chunk));
+    }
+    bytes_used += other.bytes_used;
+    bytes_reserved += other.bytes_reserved;
+
+    other.chunks.clear();
+    other.current = nullptr;
+    other.remaining = 0;
+    other.bytes_used = 0;
+    other.bytes_reserved = 0;
+}
+
+ArenaMark Arena::get_mark() const {
+    return { chunks.size(), current, remaining, bytes_used, bytes_reserved };
+}
+
+void Arena::rewind(ArenaMark mark) {
+    chunks.resize(mark.chunks_count);
+    current = mark.current;
+    remaining = mark.remaining;
+    bytes_used = mark.bytes_used;
+    bytes_reserved = mark.bytes_reserved;
+}
+
+std::size_t Arena::get_bytes_used() const {
+    return bytes_used;
+}
+
+std::size_t Arena::get_bytes_reserved() const {
+    return bytes_reserved;
+}
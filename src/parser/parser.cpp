@@ -1,18 +1,128 @@
 #include "../../include/exception/exception.hpp"
 #include "../../include/parser/parser.hpp"
+#include "../../include/lexer/lexer.hpp"
 #include "../../include/lexer/token.hpp"
 #include "../../include/parser/ast.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
 
 std::vector<StmtPtr> Parser::parse() {
     std::vector<StmtPtr> stmts;
 
-    while (pos < tokens_len) {
+    while (!is_at_end()) {
         stmts.push_back(parse_stmt());
     }
     
     return stmts;
 }
 
+// Top-level statements do not depend on each other syntactically: chunks of them are parsed on `threads_count` workers, each with its own
+// arena, and joined in source order. If a chunk fails, everything from the first failing chunk is re-parsed serially, so the reported
+// error is exactly the one of `parse`
+std::vector<StmtPtr> Parser::parse_parallel(unsigned threads_count) {
+    std::vector<unsigned long> boundaries = find_top_level_boundaries();
+    std::size_t chunks_count = boundaries.size() - 1;
+    if (lexer != nullptr || threads_count <= 1 || chunks_count <= 1) {
+        return parse();
+    }
+    if (threads_count > chunks_count) {
+        threads_count = chunks_count;
+    }
+
+    struct ChunkResult {
+        std::vector<StmtPtr> stmts;
+        bool failed = false;
+    };
+    std::vector<ChunkResult> results(chunks_count);
+    std::vector<std::unique_ptr<Arena>> worker_arenas;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> next_chunk(0);
+
+    auto work = [&](Arena& worker_arena) {
+        DeferredErrorsScope deferred_errors;
+        while (1) {
+            std::size_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= chunks_count) {
+                break;
+            }
+            std::vector<Token> chunk_tokens(tokens.begin() + boundaries[chunk], tokens.begin() + boundaries[chunk + 1]);
+            Parser chunk_parser(std::move(chunk_tokens), worker_arena);
+            try {
+                results[chunk].stmts = chunk_parser.parse();
+            }
+            catch (const CompileError&) {
+                results[chunk].failed = true;
+            }
+        }
+    };
+    for (unsigned i = 0; i < threads_count; i++) {
+        worker_arenas.push_back(std::make_unique<Arena>());
+        workers.emplace_back(work, std::ref(*worker_arenas.back()));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (std::unique_ptr<Arena>& worker_arena : worker_arenas) {
+        arena.merge(*worker_arena);
+    }
+
+    std::vector<StmtPtr> stmts;
+    for (std::size_t chunk = 0; chunk < chunks_count; chunk++) {
+        if (results[chunk].failed) {
+            pos = boundaries[chunk];
+            while (!is_at_end()) {
+                stmts.push_back(parse_stmt());
+            }
+            break;
+        }
+        stmts.insert(stmts.end(), results[chunk].stmts.begin(), results[chunk].stmts.end());
+    }
+    return stmts;
+}
+
+// Pre-scan for `parse_parallel`: a chunk may start at a `func`/`var`/`const` that follows `;` or `}` outside of any braces and parentheses.
+// Returns the first token of every chunk (each at least `PARALLEL_CHUNK_TOKENS` long) followed by `tokens_len`
+std::vector<unsigned long> Parser::find_top_level_boundaries() const {
+    std::vector<unsigned long> boundaries = { 0 };
+    int braces_depth = 0;
+    int parens_depth = 0;
+    for (unsigned long i = 1; i < tokens_len; i++) {
+        TokenType previous = tokens[i - 1].type;
+        switch (previous) {
+            case TokenType::LBRACE:
+                braces_depth++;
+                break;
+            case TokenType::RBRACE:
+                braces_depth--;
+                break;
+            case TokenType::LPAREN:
+                parens_depth++;
+                break;
+            case TokenType::RPAREN:
+                parens_depth--;
+                break;
+            default: {}
+        }
+
+        TokenType type = tokens[i].type;
+        if (braces_depth == 0 && parens_depth == 0 && (previous == TokenType::SEMICOLON || previous == TokenType::RBRACE)
+            && (type == TokenType::FUNC || type == TokenType::VAR || type == TokenType::CONST) && i - boundaries.back() >= PARALLEL_CHUNK_TOKENS) {
+            boundaries.push_back(i);
+        }
+    }
+    boundaries.push_back(tokens_len);
+    return boundaries;
+}
+
+// Streaming mode: parses one top-level statement at a time, returns `nullptr` at the end of the source
+StmtPtr Parser::parse_next() {
+    if (is_at_end()) {
+        return nullptr;
+    }
+    return parse_stmt();
+}
+
 StmtPtr Parser::parse_stmt() {
     if (peek().type == TokenType::CONST || peek().type == TokenType::VAR) {
         return parse_var_decl_stmt();
@@ -50,7 +160,7 @@ StmtPtr Parser::parse_stmt() {
         return parse_return_stmt();
     }
     else {
-        throw_error(peek().file_name, PARSER, "Unsupported token '" + peek().value + "' (" + std::to_string(peek().line) + ':' + std::to_string(peek().column) + ")\n", peek().line);
+        throw_error(peek().location, PARSER, "Unsupported token '" + std::string(peek().value) + "'\n");
     }
 }
 
@@ -61,62 +171,62 @@ StmtPtr Parser::parse_var_decl_stmt() {
     }
     else if (match(TokenType::VAR)) {}
     Token var_keyword = peek(-1);
-    std::string var_name = consume(TokenType::ID, "Expected identifier", peek().line, peek().column).value;
-    consume(TokenType::COLON, "Expected ':'", peek().line, peek().column);
-    Type var_type = consume_type(is_const);
+    Symbol var_name = consume(TokenType::ID, "Expected identifier").symbol;
+    consume(TokenType::COLON, "Expected ':'");
+    TypeId var_type = consume_type(is_const);
 
     ExprPtr var_expr = nullptr;
     if (match(TokenType::EQ)) {
         var_expr = parse_expr();
     }
 
-    consume(TokenType::SEMICOLON, "Expected ';'", peek().line, peek().column);
+    consume(TokenType::SEMICOLON, "Expected ';'");
     
-    return std::make_unique<VarDeclStmt>(var_type, var_name, std::move(var_expr), var_keyword);
+    return arena.make<VarDeclStmt>(var_type, var_name, var_expr, var_keyword.location);
 }
 
 StmtPtr Parser::parse_func_decl_stmt() {
-    Token func_name_token = consume(TokenType::ID, "Expected identifier", peek().line, peek().column);
-    std::string func_name = func_name_token.value;
-    consume(TokenType::LPAREN, "Expected '('", peek().line, peek().column);
+    Token func_name_token = consume(TokenType::ID, "Expected identifier");
+    Symbol func_name = func_name_token.symbol;
+    consume(TokenType::LPAREN, "Expected '('");
     std::vector<Argument> args;
     while (!match(TokenType::RPAREN)) {
         args.push_back(parse_argument());
     }
-    consume(TokenType::COLON, "Expected ':'", peek().line, peek().column);
+    consume(TokenType::COLON, "Expected ':'");
     bool is_const = false;
     if (match(TokenType::CONST)) {
         is_const = true;
     }
-    Type func_type = consume_type(is_const);
-    consume(TokenType::LBRACE, "Expected '{'", peek().line, peek().column);
+    TypeId func_type = consume_type(is_const);
+    consume(TokenType::LBRACE, "Expected '{'");
     
     std::vector<StmtPtr> block;
     while (!match(TokenType::RBRACE)) {
         block.push_back(parse_stmt());
     }
     
-    return std::make_unique<FuncDeclStmt>(func_type, func_name, std::move(args), std::move(block), func_name_token);
+    return arena.make<FuncDeclStmt>(func_type, func_name, arena.copy(args), arena.copy(block), func_name_token.location);
 }
 
 StmtPtr Parser::parse_func_call_stmt() {
-    Token func_name_token = consume(TokenType::ID, "Expected identifier", peek().line, peek().column);
-    std::string func_name = func_name_token.value;
+    Token func_name_token = consume(TokenType::ID, "Expected identifier");
+    Symbol func_name = func_name_token.symbol;
     pos++;
     std::vector<ExprPtr> func_args;
     while (!match(TokenType::RPAREN)) {
         func_args.push_back(parse_expr());
         if (peek().type != TokenType::RPAREN) {
-            consume(TokenType::COMMA, "Expected ','", peek().line, peek().column);
+            consume(TokenType::COMMA, "Expected ','");
         }
     }
-    consume(TokenType::SEMICOLON, "Expected ';'", peek().line, peek().column);
-    return std::make_unique<FuncCallStmt>(func_name, std::move(func_args), func_name_token);
+    consume(TokenType::SEMICOLON, "Expected ';'");
+    return arena.make<FuncCallStmt>(func_name, arena.copy(func_args), func_name_token.location);
 }
 
 StmtPtr Parser::parse_var_asgn_stmt(bool from_for_cycle) {
-    Token var_name_token = consume(TokenType::ID, "Expected identifier", peek().line, peek().column);
-    std::string var_name = var_name_token.value;
+    Token var_name_token = consume(TokenType::ID, "Expected identifier");
+    Symbol var_name = var_name_token.symbol;
 
     Token op = peek();
     ExprPtr expr = nullptr;
@@ -124,20 +234,20 @@ StmtPtr Parser::parse_var_asgn_stmt(bool from_for_cycle) {
         expr = create_compound_assignment_operator(var_name);
     }
     else {
-        consume(TokenType::EQ, "Expected '='", op.line, op.column);
+        consume(TokenType::EQ, "Expected '='");
         expr = parse_expr();
     }
     if (!from_for_cycle) {
-        consume(TokenType::SEMICOLON, "Expected ';'", peek().line, peek().column);
+        consume(TokenType::SEMICOLON, "Expected ';'");
     }
-    return std::make_unique<VarAsgnStmt>(var_name, std::move(expr), var_name_token);
+    return arena.make<VarAsgnStmt>(var_name, expr, var_name_token.location);
 }
 
 StmtPtr Parser::parse_if_stmt() {
     Token if_keyword = peek(-1);
-    consume(TokenType::LPAREN, "Expected '('", peek().line, peek().column);
+    consume(TokenType::LPAREN, "Expected '('");
     ExprPtr condition = parse_expr();
-    consume(TokenType::RPAREN, "Expected ')'", peek().line, peek().column);
+    consume(TokenType::RPAREN, "Expected ')'");
 
     std::vector<StmtPtr> true_block;
     if (!match(TokenType::LBRACE)) {
@@ -160,12 +270,12 @@ StmtPtr Parser::parse_if_stmt() {
         }
     }
 
-    return std::make_unique<IfStmt>(std::move(condition), std::move(true_block), std::move(false_block), if_keyword);
+    return arena.make<IfStmt>(condition, arena.copy(true_block), arena.copy(false_block), if_keyword.location);
 }
 
 StmtPtr Parser::parse_for_cycle_stmt() {
     Token for_keyword = peek(-1);
-    consume(TokenType::LPAREN, "Expected '('", peek().line, peek().column);
+    consume(TokenType::LPAREN, "Expected '('");
     StmtPtr indexator = nullptr;
     if (peek(1).type == TokenType::COLON) {
         indexator = parse_var_decl_stmt();
@@ -175,9 +285,9 @@ StmtPtr Parser::parse_for_cycle_stmt() {
     }
     // `;` already missed before
     ExprPtr condition = parse_expr();
-    consume(TokenType::SEMICOLON, "Expected ';'", peek().line, peek().column);
+    consume(TokenType::SEMICOLON, "Expected ';'");
     StmtPtr iteration = parse_var_asgn_stmt(true);
-    consume(TokenType::RPAREN, "Expected ')'", peek().line, peek().column);
+    consume(TokenType::RPAREN, "Expected ')'");
 
     std::vector<StmtPtr> block;
     if (!match(TokenType::LBRACE)) {
@@ -189,14 +299,14 @@ StmtPtr Parser::parse_for_cycle_stmt() {
         }
     }
 
-    return std::make_unique<ForCycleStmt>(std::move(indexator), std::move(condition), std::move(iteration), std::move(block), for_keyword);
+    return arena.make<ForCycleStmt>(indexator, condition, iteration, arena.copy(block), for_keyword.location);
 }
 
 StmtPtr Parser::parse_while_cycle_stmt() {
     Token while_keyword = peek(-1);
-    consume(TokenType::LPAREN, "Expected '('", peek().line, peek().column);
+    consume(TokenType::LPAREN, "Expected '('");
     ExprPtr condition = parse_expr();
-    consume(TokenType::RPAREN, "Expected ')'", peek().line, peek().column);
+    consume(TokenType::RPAREN, "Expected ')'");
 
     std::vector<StmtPtr> block;
     if (!match(TokenType::LBRACE)) {
@@ -208,7 +318,7 @@ StmtPtr Parser::parse_while_cycle_stmt() {
         }
     }
 
-    return std::make_unique<WhileCycleStmt>(std::move(condition), std::move(block), while_keyword);
+    return arena.make<WhileCycleStmt>(condition, arena.copy(block), while_keyword.location);
 }
 
 StmtPtr Parser::parse_do_while_cycle_stmt() {
@@ -223,25 +333,25 @@ StmtPtr Parser::parse_do_while_cycle_stmt() {
         }
     }
     
-    consume(TokenType::WHILE, "Expected 'while'", peek().line, peek().column);
-    consume(TokenType::LPAREN, "Expected '('", peek().line, peek().column);
+    consume(TokenType::WHILE, "Expected 'while'");
+    consume(TokenType::LPAREN, "Expected '('");
     ExprPtr condition = parse_expr();
-    consume(TokenType::RPAREN, "Expected ')'", peek().line, peek().column);
-    consume(TokenType::SEMICOLON, "Expected ';'", peek().line, peek().column);
+    consume(TokenType::RPAREN, "Expected ')'");
+    consume(TokenType::SEMICOLON, "Expected ';'");
 
-    return std::make_unique<DoWhileCycleStmt>(std::move(condition), std::move(block), do_keyword);
+    return arena.make<DoWhileCycleStmt>(condition, arena.copy(block), do_keyword.location);
 }
 
 StmtPtr Parser::parse_break_stmt() {
     Token break_keyword = peek(-1);
-    consume(TokenType::SEMICOLON, "Expected ';'", peek().line, peek().column);
-    return std::make_unique<BreakStmt>(break_keyword);
+    consume(TokenType::SEMICOLON, "Expected ';'");
+    return arena.make<BreakStmt>(break_keyword.location);
 }
 
 StmtPtr Parser::parse_continue_stmt() {
     Token continue_keyword = peek(-1);
-    consume(TokenType::SEMICOLON, "Expected ';'", peek().line, peek().column);
-    return std::make_unique<ContinueStmt>(continue_keyword);
+    consume(TokenType::SEMICOLON, "Expected ';'");
+    return arena.make<ContinueStmt>(continue_keyword.location);
 }
 
 StmtPtr Parser::parse_return_stmt() {
@@ -250,145 +360,97 @@ StmtPtr Parser::parse_return_stmt() {
     if (peek().type != TokenType::SEMICOLON) {
         expr = parse_expr();
     }
-    consume(TokenType::SEMICOLON, "Expected ';'", peek().line, peek().column);
-    return std::make_unique<ReturnStmt>(std::move(expr), return_keyword);
+    consume(TokenType::SEMICOLON, "Expected ';'");
+    return arena.make<ReturnStmt>(expr, return_keyword.location);
 }
 
 Argument Parser::parse_argument() {
-    Token arg_name_token = consume(TokenType::ID, "Expected identifier", peek().line, peek().column);
-    std::string arg_name = arg_name_token.value;
-    consume(TokenType::COLON, "Expected ':'", peek().line, peek().column);
+    Token arg_name_token = consume(TokenType::ID, "Expected identifier");
+    Symbol arg_name = arg_name_token.symbol;
+    consume(TokenType::COLON, "Expected ':'");
     bool is_const = match(TokenType::CONST);
-    Type arg_type = consume_type(is_const);
+    TypeId arg_type = consume_type(is_const);
     ExprPtr arg_expr = nullptr;
     if (match(TokenType::EQ)) {
         arg_expr = parse_expr();
     }
     if (peek().type != TokenType::RPAREN) {
-        consume(TokenType::COMMA, "Expected ','", peek().line, peek().column);
+        consume(TokenType::COMMA, "Expected ','");
     }
-    return Argument(arg_type, arg_name, std::move(arg_expr), arg_name_token);
+    return Argument(arg_type, arg_name, arg_expr, arg_name_token.location);
 }
 
+// Precedence climbing over explicit operand/operator stacks: every binary operator the lexer produces is handled in one loop,
+// prefix operators and parentheses are pushed on the operator stack, so nesting depth does not grow the call stack
 ExprPtr Parser::parse_expr() {
-    return parse_l_and();
-}
-
-ExprPtr Parser::parse_l_and() {
-    ExprPtr expr = parse_l_or();
-    
-    while (match(TokenType::L_AND)) {
-        expr = std::make_unique<BinaryExpr>(TokenType::L_AND, std::move(expr), std::move(parse_l_or()), expr->first_token);
-    }
-
-    return expr;
-}
-
-ExprPtr Parser::parse_l_or() {
-    ExprPtr expr = parse_equality();
-    
-    while (match(TokenType::L_OR)) {
-        expr = std::make_unique<BinaryExpr>(TokenType::L_OR, std::move(expr), std::move(parse_equality()), expr->first_token);
-    }
-
-    return expr;
-}
-
-ExprPtr Parser::parse_equality() {
-    ExprPtr expr = parse_comparation();
-    
-    while (1) {
-        if (match(TokenType::EQ_EQ)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::EQ_EQ, std::move(expr), std::move(parse_comparation()), expr->first_token);
-        }
-        else if (match(TokenType::NOT_EQ)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::NOT_EQ, std::move(expr), std::move(parse_comparation()), expr->first_token);
-        }
-        else {
-            break;
-        }
-    }
-
-    return expr;
-}
-
-ExprPtr Parser::parse_comparation() {
-    ExprPtr expr = parse_multiplicative();
-    
-    while (1) {
-        if (match(TokenType::GT)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::GT, std::move(expr), std::move(parse_multiplicative()), expr->first_token);
-        }
-        else if (match(TokenType::GT_EQ)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::GT_EQ, std::move(expr), std::move(parse_multiplicative()), expr->first_token);
+    std::vector<ExprPtr> operands;
+    std::vector<PendingOperator> operators;
+    int open_parens = 0;
+
+    auto reduce = [&]() {
+        PendingOperator op = operators.back();
+        operators.pop_back();
+
+        ExprPtr right = operands.back();
+        operands.pop_back();
+        if (op.is_unary) {
+            operands.push_back(arena.make<UnaryExpr>(op.type, right, op.location));
+            return;
         }
-        else if (match(TokenType::LS)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::LS, std::move(expr), std::move(parse_multiplicative()), expr->first_token);
-        }
-        else if (match(TokenType::LS_EQ)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::LS_EQ, std::move(expr), std::move(parse_multiplicative()), expr->first_token);
-        }
-        else {
-            break;
-        }
-    }
+        ExprPtr left = operands.back();
+        operands.back() = arena.make<BinaryExpr>(op.type, left, right, left->location);
+    };
 
-    return expr;
-}
-
-ExprPtr Parser::parse_multiplicative() {
-    ExprPtr expr = parse_additive();
-    
     while (1) {
-        if (match(TokenType::MULT)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::MULT, std::move(expr), std::move(parse_additive()), expr->first_token);
-        }
-        else if (match(TokenType::DIV)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::DIV, std::move(expr), std::move(parse_additive()), expr->first_token);
-        }
-        else if (match(TokenType::MODULO)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::MODULO, std::move(expr), std::move(parse_additive()), expr->first_token);
-        }
-        else {
-            break;
+        while (1) {
+            Token token = peek();
+            if (token.type == TokenType::MINUS || token.type == TokenType::L_NOT || token.type == TokenType::B_NOT) {
+                operators.push_back({ token.type, UNARY_PRECEDENCE, true, token.location });
+            }
+            else if (token.type == TokenType::LPAREN) {
+                operators.push_back({ token.type, 0, false, token.location });
+                open_parens++;
+            }
+            else {
+                break;
+            }
+            pos++;
         }
-    }
 
-    return expr;
-}
+        operands.push_back(parse_primary());
 
-ExprPtr Parser::parse_additive() {
-    ExprPtr expr = parse_unary();
-    
-    while (1) {
-        if (match(TokenType::MINUS)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::MINUS, std::move(expr), std::move(parse_unary()), expr->first_token);
-        }
-        else if (match(TokenType::PLUS)) {
-            expr = std::make_unique<BinaryExpr>(TokenType::PLUS, std::move(expr), std::move(parse_unary()), expr->first_token);
-        }
-        else {
-            break;
-        }
-    }
+        while (1) {
+            Token token = peek();
+            if (token.type == TokenType::RPAREN && open_parens > 0) {
+                while (operators.back().type != TokenType::LPAREN) {
+                    reduce();
+                }
+                operators.pop_back();
+                open_parens--;
+                pos++;
+                continue;
+            }
 
-    return expr;
-}
+            int precedence = get_binary_precedence(token.type);
+            if (precedence == 0) {
+                if (open_parens > 0) {
+                    throw_error(token.location, PARSER, "Expected ')'\n");
+                }
+                while (!operators.empty()) {
+                    reduce();
+                }
+                return operands.back();
+            }
 
-ExprPtr Parser::parse_unary() {
-    while (1) {
-        if (match(TokenType::MINUS)) {
-            return std::make_unique<UnaryExpr>(TokenType::MINUS, std::move(parse_primary()), peek());
-        }
-        else if (match(TokenType::L_NOT)) {
-            return std::make_unique<UnaryExpr>(TokenType::L_NOT, std::move(parse_primary()), peek());
-        }
-        else {
+            // All binary operators are left-associative
+            while (!operators.empty() && operators.back().precedence >= precedence) {
+                reduce();
+            }
+            operators.push_back({ token.type, precedence, false, token.location });
+            pos++;
             break;
         }
     }
-
-    return parse_primary();
 }
 
 ExprPtr Parser::parse_primary() {
@@ -397,40 +459,40 @@ ExprPtr Parser::parse_primary() {
     switch (token.type) {
         case TokenType::I8_LIT:
             pos++;
-            return std::make_unique<I8Literal>(token.value[0], token);
+            return arena.make<I8Literal>((std::int8_t)token.int_value, token.location);
         case TokenType::I16_LIT:
             pos++;
-            return std::make_unique<I16Literal>(std::stoll(token.value), token);
+            return arena.make<I16Literal>((std::int16_t)token.int_value, token.location);
         case TokenType::I32_LIT:
             pos++;
-            return std::make_unique<I32Literal>(std::stoll(token.value), token);
+            return arena.make<I32Literal>((std::int32_t)token.int_value, token.location);
         case TokenType::I64_LIT:
             pos++;
-            return std::make_unique<I64Literal>(std::stoll(token.value), token);
+            return arena.make<I64Literal>((std::int64_t)token.int_value, token.location);
         case TokenType::F32_LIT:
             pos++;
-            return std::make_unique<F32Literal>(std::stold(token.value), token);
+            return arena.make<F32Literal>((std::float_t)token.float_value, token.location);
         case TokenType::F64_LIT:
             pos++;
-            return std::make_unique<F64Literal>(std::stold(token.value), token);
+            return arena.make<F64Literal>(token.float_value, token.location);
         case TokenType::U8_LIT:
             pos++;
-            return std::make_unique<U8Literal>((std::uint8_t)(token.value[0]), token);
+            return arena.make<U8Literal>((std::uint8_t)token.int_value, token.location);
         case TokenType::U16_LIT:
             pos++;
-            return std::make_unique<U16Literal>((std::uint16_t)std::stoull(token.value), token);
+            return arena.make<U16Literal>((std::uint16_t)token.int_value, token.location);
         case TokenType::U32_LIT:
             pos++;
-            return std::make_unique<U32Literal>((std::uint32_t)std::stoull(token.value), token);
+            return arena.make<U32Literal>((std::uint32_t)token.int_value, token.location);
         case TokenType::U64_LIT:
             pos++;
-            return std::make_unique<U64Literal>((std::uint64_t)std::stoull(token.value), token);
+            return arena.make<U64Literal>(token.int_value, token.location);
         case TokenType::BOOL_LIT:
             pos++;
-            return std::make_unique<BoolLiteral>(token.value == "true", token);
+            return arena.make<BoolLiteral>(token.value == "true", token.location);
         case TokenType::STRING_LIT:
             pos++;
-            return std::make_unique<StringLiteral>(token.value, token);
+            return arena.make<StringLiteral>(arena.copy_string(unescape_string(token.value)), token.location);
         case TokenType::ID:
             pos++;
             if (match(TokenType::LPAREN)) {
@@ -438,14 +500,14 @@ ExprPtr Parser::parse_primary() {
                 while (!match(TokenType::RPAREN)) {
                     func_args.push_back(parse_expr());
                     if (peek().type != TokenType::RPAREN) {
-                        consume(TokenType::COMMA, "Expected ','", peek().line, peek().column);
+                        consume(TokenType::COMMA, "Expected ','");
                     }
                 }
-                return std::make_unique<FuncCallExpr>(token.value, std::move(func_args), token);
+                return arena.make<FuncCallExpr>(token.symbol, arena.copy(func_args), token.location);
             }
-            return std::make_unique<VarExpr>(token.value, token);
+            return arena.make<VarExpr>(token.symbol, token.location);
         default:
-            throw_error(token.file_name, PARSER, "Unexpected token '" + token.value + "' (" + std::to_string(token.line) + ':' + std::to_string(token.column) + ")\n", token.line);
+            throw_error(token.location, PARSER, "Unexpected token '" + std::string(token.value) + "'\n");
     }
 }
 
@@ -453,36 +515,67 @@ bool Parser::is_compound_assignment_operator(TokenType type) const {
     return type == TokenType::PLUS_EQ || type == TokenType::MINUS_EQ || type == TokenType::MULT_EQ || type == TokenType::DIV_EQ || type == TokenType::MODULO_EQ;
 }
 
-ExprPtr Parser::create_compound_assignment_operator(std::string id) {
+ExprPtr Parser::create_compound_assignment_operator(Symbol id) {
     Token token = peek();
     pos++;
     switch (token.type) {
         case TokenType::PLUS_EQ:
-            return std::make_unique<BinaryExpr>(TokenType::PLUS, std::make_unique<VarExpr>(id, token), parse_expr(), token);
+            return arena.make<BinaryExpr>(TokenType::PLUS, arena.make<VarExpr>(id, token.location), parse_expr(), token.location);
         case TokenType::MINUS_EQ:
-            return std::make_unique<BinaryExpr>(TokenType::MINUS, std::make_unique<VarExpr>(id, token), parse_expr(), token);
+            return arena.make<BinaryExpr>(TokenType::MINUS, arena.make<VarExpr>(id, token.location), parse_expr(), token.location);
         case TokenType::MULT_EQ:
-            return std::make_unique<BinaryExpr>(TokenType::MULT, std::make_unique<VarExpr>(id, token), parse_expr(), token);
+            return arena.make<BinaryExpr>(TokenType::MULT, arena.make<VarExpr>(id, token.location), parse_expr(), token.location);
         case TokenType::DIV_EQ:
-            return std::make_unique<BinaryExpr>(TokenType::DIV, std::make_unique<VarExpr>(id, token), parse_expr(), token);
+            return arena.make<BinaryExpr>(TokenType::DIV, arena.make<VarExpr>(id, token.location), parse_expr(), token.location);
         case TokenType::MODULO_EQ:
-            return std::make_unique<BinaryExpr>(TokenType::MODULO, std::make_unique<VarExpr>(id, token), parse_expr(), token);
+            return arena.make<BinaryExpr>(TokenType::MODULO, arena.make<VarExpr>(id, token.location), parse_expr(), token.location);
         default: {
-            throw_error(token.file_name, PARSER, "Unsupported compound assignment operator (" + std::to_string(token.line) + ':' + std::to_string(token.column) + ")\n", token.line);
+            throw_error(token.location, PARSER, "Unsupported compound assignment operator\n");
         }
     }
 }
 
+int Parser::get_binary_precedence(TokenType type) const {
+    switch (type) {
+        case TokenType::L_OR:
+            return 1;
+        case TokenType::L_AND:
+            return 2;
+        case TokenType::B_OR:
+            return 3;
+        case TokenType::B_XOR:
+            return 4;
+        case TokenType::B_AND:
+            return 5;
+        case TokenType::EQ_EQ:
+        case TokenType::NOT_EQ:
+            return 6;
+        case TokenType::GT:
+        case TokenType::GT_EQ:
+        case TokenType::LS:
+        case TokenType::LS_EQ:
+            return 7;
+        case TokenType::L_SHIFT:
+        case TokenType::R_SHIFT:
+            return 8;
+        case TokenType::PLUS:
+        case TokenType::MINUS:
+            return 9;
+        case TokenType::MULT:
+        case TokenType::DIV:
+        case TokenType::MODULO:
+            return 10;
+        default:
+            return 0;
+    }
+}
+
 bool Parser::is_type(TokenType type) const {
     return type == TokenType::I8 || type == TokenType::I16 || type == TokenType::I32 || type == TokenType::I64 || type == TokenType::F32 || type == TokenType::F64
         || type == TokenType::U8 || type == TokenType::U16 || type == TokenType::U32 || type == TokenType::U64 || type == TokenType::BOOL
         || type == TokenType::NOTHING;
 }
 
-bool Parser::is_unsigned_type(TokenType type) const {
-    return type == TokenType::U8 || type == TokenType::U16 || type == TokenType::U32 || type == TokenType::U64;
-}
-
 TypeValue Parser::token_type_to_type_value(Token token) {
     if (is_type(token.type)) {
         switch (token.type) {
@@ -520,34 +613,50 @@ TypeValue Parser::token_type_to_type_value(Token token) {
         return TypeValue::ENUM;
     }
     else {
-        throw_error(token.file_name, PARSER, "Expected type (" + std::to_string(token.line) + ':' + std::to_string(token.column) + ")\n", token.line);
+        throw_error(token.location, PARSER, "Expected type\n");
     }
 }
 
-Type Parser::consume_type(bool is_const) {
+TypeId Parser::consume_type(bool is_const) {
     Token token = peek();
     if (!is_type(token.type)) {
-        throw_error(token.file_name, PARSER, "Expected type (" + std::to_string(token.line) + ':' + std::to_string(token.column) + ")\n", token.line);
+        throw_error(token.location, PARSER, "Expected type\n");
     }
     pos++;
     bool is_pointer = match(TokenType::MULT);
-    return Type(token_type_to_type_value(token), token.value, is_const, is_unsigned_type(token.type), is_pointer);
+    return TypeContext::get(token_type_to_type_value(token), is_const, is_pointer ? 1 : 0);
+}
+
+bool Parser::is_at_end() {
+    if (lexer != nullptr) {
+        return peek().type == TokenType::END_OF_FILE;
+    }
+    return static_cast<unsigned long>(pos) >= tokens_len;
 }
 
-Token Parser::peek(int rpos) const {
+Token Parser::peek(int rpos) {
+    unsigned long index = pos + rpos;
+    if (lexer != nullptr) {
+        // after the end of the source the lexer keeps returning `END_OF_FILE`
+        while (index >= tokens_len) {
+            tokens[tokens_len & (TOKEN_RING_SIZE - 1)] = lexer->next_token();
+            tokens_len++;
+        }
+        return tokens[index & (TOKEN_RING_SIZE - 1)];
+    }
     if (pos + rpos >= tokens_len) {
-        throw_error(tokens[0].file_name, PARSER, "Index out of range: (" + std::to_string(pos + rpos) + "/" + std::to_string(tokens_len) + ")\n", peek().line);
+        throw_error(tokens[tokens_len - 1].location, PARSER, "Index out of range: (" + std::to_string(pos + rpos) + "/" + std::to_string(tokens_len) + ")\n");
     }
     return tokens[pos + rpos];
 }
 
-Token Parser::consume(TokenType type, std::string err_msg, int line, int column) {
+Token Parser::consume(TokenType type, std::string err_msg) {
     Token token = peek();
     if (token.type == type) {
         pos++;
         return token;
     }
-    throw_error(token.file_name, PARSER, err_msg + " (" + std::to_string(line) + ':' + std::to_string(column) + ")\n", line);
+    throw_error(token.location, PARSER, err_msg + '\n');
 }
 
 bool Parser::match(TokenType type) {
@@ -1,340 +1,586 @@
 #include "../../include/exception/exception.hpp"
 #include <iostream>
+#include <optional>
+#include <memory>
+#include <atomic>
+#include <thread>
 #include "../../include/semantic/semantic.hpp"
 
-void SemanticAnalyzer::analyze() {
-    for (const StmtPtr& stmt : stmts) {
-        analyze_stmt(*stmt);
+// First collects function signatures and then checks globals and other top-level statements in source order, so that any function
+// can be called from anywhere. Function bodies only read those tables afterwards and are checked by `threads_count` workers, each with
+// its own scopes. Errors are deferred and the first one in source order is reported
+void SemanticAnalyzer::analyze(unsigned threads_count) {
+    std::size_t stmts_count = stmts.size();
+    std::vector<std::optional<CompileError>> errors(stmts_count);
+    std::size_t checked_count = stmts_count;    // statements after the first failed top-level one are not checked
+
+    {
+        DeferredErrorsScope deferred_errors;
+        for (std::size_t i = 0; i < checked_count; i++) {
+            if (stmts[i]->kind == NodeKind::FUNC_DECL_STMT) {
+                try {
+                    declare_function(static_cast<FuncDeclStmt&>(*stmts[i]));
+                }
+                catch (CompileError& error) {
+                    errors[i] = std::move(error);
+                    checked_count = i;
+                }
+            }
+        }
+        called_functions.clear();
+        for (std::size_t i = 0; i < checked_count; i++) {
+            if (stmts[i]->kind != NodeKind::FUNC_DECL_STMT) {
+                try {
+                    analyze_stmt(*stmts[i]);
+                }
+                catch (CompileError& error) {
+                    errors[i] = std::move(error);
+                    checked_count = i;
+                }
+            }
+        }
     }
-}
 
-void SemanticAnalyzer::analyze_stmt(Stmt& stmt) {
-    if (auto vds = dynamic_cast<VarDeclStmt*>(&stmt)) {
-        analyze_var_decl_stmt(*vds);
-    }
-    else if (auto fds = dynamic_cast<FuncDeclStmt*>(&stmt)) {
-        analyze_func_decl_stmt(*fds);
-    }
-    else if (auto fcs = dynamic_cast<FuncCallStmt*>(&stmt)) {
-        analyze_func_call_stmt(*fcs);
-    }
-    else if (auto vas = dynamic_cast<VarAsgnStmt*>(&stmt)) {
-        analyze_var_asgn_stmt(*vas);
-    }
-    else if (auto is = dynamic_cast<IfStmt*>(&stmt)) {
-        analyze_if_stmt(*is);
-    }
-    else if (auto fcs = dynamic_cast<ForCycleStmt*>(&stmt)) {
-        analyze_for_cycle_stmt(*fcs);
-    }
-    else if (auto wcs = dynamic_cast<WhileCycleStmt*>(&stmt)) {
-        analyze_while_cycle_stmt(*wcs);
+    top_level_callees = std::move(called_functions);
+    callees.assign(functions_count, {});
+    std::vector<std::size_t> bodies;
+    for (std::size_t i = 0; i < checked_count; i++) {
+        if (stmts[i]->kind == NodeKind::FUNC_DECL_STMT) {
+            bodies.push_back(i);
+        }
     }
-    else if (auto dwcs = dynamic_cast<DoWhileCycleStmt*>(&stmt)) {
-        analyze_do_while_cycle_stmt(*dwcs);
+    std::uint32_t globals_count = variables_count;
+    std::atomic<std::size_t> next_body(0);
+
+    auto work = [&]() {
+        DeferredErrorsScope deferred_errors;
+        std::unique_ptr<SemanticAnalyzer> worker(new SemanticAnalyzer(this));
+        while (1) {
+            std::size_t body = next_body.fetch_add(1, std::memory_order_relaxed);
+            if (body >= bodies.size()) {
+                break;
+            }
+            // locals of different functions are never alive together, so every function numbers its own from `globals_count`
+            worker->variables_count = globals_count;
+            worker->called_functions.clear();
+            try {
+                FuncDeclStmt& fds = static_cast<FuncDeclStmt&>(*stmts[bodies[body]]);
+                worker->analyze_func_body(fds);
+                callees[fds.function_id] = std::move(worker->called_functions);
+            }
+            catch (CompileError& error) {
+                errors[bodies[body]] = std::move(error);
+                worker.reset(new SemanticAnalyzer(this));    // scopes are left half-entered by the error
+            }
+        }
+    };
+    if (threads_count > bodies.size()) {
+        threads_count = bodies.size();
     }
-    else if (auto bs = dynamic_cast<BreakStmt*>(&stmt)) {
-        analyze_break_stmt(*bs);
+    if (threads_count <= 1) {
+        work();
     }
-    else if (auto cs = dynamic_cast<ContinueStmt*>(&stmt)) {
-        analyze_continue_stmt(*cs);
+    else {
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < threads_count; i++) {
+            workers.emplace_back(work);
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
     }
-    else if (auto rs = dynamic_cast<ReturnStmt*>(&stmt)) {
-        analyze_return_stmt(*rs);
+
+    for (std::optional<CompileError>& error : errors) {
+        if (error) {
+            report_error(*error);
+        }
     }
-    else {
-        throw_error(stmt.first_token.file_name, SEMANTIC, "Unsupported statement\n", stmt.first_token.line);
+}
+
+void SemanticAnalyzer::analyze_stmt(Stmt& stmt) {
+    switch (stmt.kind) {
+        case NodeKind::VAR_DECL_STMT:
+            analyze_var_decl_stmt(static_cast<VarDeclStmt&>(stmt));
+            break;
+        case NodeKind::FUNC_DECL_STMT:
+            analyze_func_decl_stmt(static_cast<FuncDeclStmt&>(stmt));
+            break;
+        case NodeKind::FUNC_CALL_STMT:
+            analyze_func_call_stmt(static_cast<FuncCallStmt&>(stmt));
+            break;
+        case NodeKind::VAR_ASGN_STMT:
+            analyze_var_asgn_stmt(static_cast<VarAsgnStmt&>(stmt));
+            break;
+        case NodeKind::IF_STMT:
+            analyze_if_stmt(static_cast<IfStmt&>(stmt));
+            break;
+        case NodeKind::FOR_CYCLE_STMT:
+            analyze_for_cycle_stmt(static_cast<ForCycleStmt&>(stmt));
+            break;
+        case NodeKind::WHILE_CYCLE_STMT:
+            analyze_while_cycle_stmt(static_cast<WhileCycleStmt&>(stmt));
+            break;
+        case NodeKind::DO_WHILE_CYCLE_STMT:
+            analyze_do_while_cycle_stmt(static_cast<DoWhileCycleStmt&>(stmt));
+            break;
+        case NodeKind::BREAK_STMT:
+            analyze_break_stmt(static_cast<BreakStmt&>(stmt));
+            break;
+        case NodeKind::CONTINUE_STMT:
+            analyze_continue_stmt(static_cast<ContinueStmt&>(stmt));
+            break;
+        case NodeKind::RETURN_STMT:
+            analyze_return_stmt(static_cast<ReturnStmt&>(stmt));
+            break;
+        default:
+            throw_error(stmt.location, SEMANTIC, "Unsupported statement\n");
     }
 }
 
 void SemanticAnalyzer::analyze_var_decl_stmt(VarDeclStmt& vds) {
-    auto vars = variables;
-    while (!vars.empty()) {
-        auto var_it = vars.top().find(vds.name);
-        if (var_it != vars.top().end()) {
-            throw_error(vds.first_token.file_name, SEMANTIC, "Variable '" + vds.name + "' already exist\n", vds.first_token.line);
-        }
-        vars.pop();
+    if (variables.lookup(vds.name) != nullptr) {
+        throw_error(vds.location, SEMANTIC, "Variable '" + std::string(Interner::get_name(vds.name)) + "' already exist\n");
     }
     
+    bool is_global = functions_types_stack.empty();
+    bool is_const = TypeContext::get_info(vds.type).is_const;
     if (vds.expr != nullptr) {
-        Type expr_type = analyze_expr(*vds.expr);
-        get_common_type(vds.type, expr_type, vds.first_token);
+        analyze_expr(*vds.expr);
+        convert(*vds.expr, vds.type, vds.location);
+        // globals are initialized in the object file; calls are allowed for `const` ones, `ConstantFolder` runs them
+        if (is_global && !is_constant_initializer(*vds.expr, is_const)) {
+            throw_error(vds.location, SEMANTIC, "Initializer of global variable '" + std::string(Interner::get_name(vds.name)) + "' must be constant\n");
+        }
     }
 
-    variables.top().emplace(vds.name, vds.type);
+    vds.variable_id = variables_count++;
+    variables.declare(vds.name, { vds.type, vds.variable_id, is_global && is_const && vds.expr != nullptr });
 }
 
 void SemanticAnalyzer::analyze_func_decl_stmt(FuncDeclStmt& fds) {
-    auto func_it = functions.find(fds.name);
-    if (func_it != functions.end()) {
+    if (!functions_types_stack.empty()) {
+        throw_error(fds.location, SEMANTIC, "Functions must be declared at the top level\n");
+    }
+    declare_function(fds);
+    analyze_func_body(fds);
+    called_functions.clear();     // single-pass (streaming) analysis does not prune functions
+}
+
+void SemanticAnalyzer::declare_function(FuncDeclStmt& fds) {
+    auto func_it = functions->find(fds.name);
+    if (func_it != functions->end()) {
+        // the message names the existing declaration, so its arguments are listed
+        const std::vector<Argument>& existing_args = func_it->second.args;
         std::string joined_args;
-        if (!fds.args.empty()) {
-            joined_args.reserve();
-            joined_args.append(type_to_string(func_it->second.args[0].type));
-            unsigned args_size = func_it->second.args.size();
+        if (!existing_args.empty()) {
+            joined_args.append(TypeContext::to_string(existing_args[0].type));
+            unsigned args_size = existing_args.size();
             for (unsigned i = 1; i < args_size; i++) {
                 joined_args.append(", ");
-                joined_args.append(type_to_string(fds.args[i].type));
+                joined_args.append(TypeContext::to_string(existing_args[i].type));
             }
         }
-        throw_error(fds.first_token.file_name, SEMANTIC, "Function '" + type_to_string(func_it->second.return_type) + ' ' + func_it->first + '(' + joined_args + ")' already exist\n", fds.first_token.line);
+        throw_error(fds.location, SEMANTIC, "Function '" + TypeContext::to_string(func_it->second.return_type) + ' ' + std::string(Interner::get_name(func_it->first)) + '(' + joined_args + ")' already exist\n");
     }
 
-    std::vector<Argument> args_copy = fds.args;
-    
-    variables.push({});
+    std::vector<Argument> args_copy(fds.args.begin(), fds.args.end());
+    fds.function_id = functions_count++;
+    declared_functions.emplace(fds.name, FunctionInfo(fds.return_type, std::move(args_copy), fds.function_id));
+}
+
+void SemanticAnalyzer::analyze_func_body(FuncDeclStmt& fds) {
+    variables.push_scope();
     functions_types_stack.push(fds.return_type);
-    functions.emplace(fds.name, FunctionInfo(fds.return_type, std::move(args_copy)));
-    for (const Argument& arg : fds.args) {
-        variables.top().emplace(arg.name, arg.type);
+    for (Argument& arg : fds.args) {
+        arg.variable_id = variables_count++;
+        variables.declare(arg.name, { arg.type, arg.variable_id, false });
     }
     for (const StmtPtr& stmt : fds.block) {
         analyze_stmt(*stmt);
     }
     functions_types_stack.pop();
-    variables.pop();
+    variables.pop_scope();
 }
 
 void SemanticAnalyzer::analyze_func_call_stmt(FuncCallStmt& fcs) {
-    if (fcs.name == "printf") {
-        return;
-    }
-
-    auto func_it = functions.find(fcs.name);
-    if (func_it == functions.end()) {
-        std::string joined_args;
-        if (!fcs.args.empty()) {
-            joined_args.reserve();
-            joined_args.append(type_to_string(analyze_expr(*fcs.args[0])));
-            unsigned args_size = fcs.args.size();
-            for (unsigned i = 1; i < args_size; i++) {
-                joined_args.append(", ");
-                joined_args.append(type_to_string(analyze_expr(*fcs.args[i])));
-            }
-        }
-        throw_error(fcs.first_token.file_name, SEMANTIC, "Function '" + fcs.name + '(' + joined_args + ")' does not exist\n", fcs.first_token.line);
-    }
-
-    unsigned args_size = fcs.args.size();
-    for (unsigned i = 0; i < args_size; i++) {
-        get_common_type(analyze_expr(*fcs.args[i]), func_it->second.args[i].type, fcs.first_token);
-    }
+    analyze_call(fcs.name, fcs.args, fcs.function_id, fcs.location);
 }
 
 void SemanticAnalyzer::analyze_var_asgn_stmt(VarAsgnStmt& vas) {
-    Type var_type = analyze_var_expr(VarExpr(vas.name, vas.first_token));
+    VariableInfo* variable = variables.lookup(vas.name);
+    if (variable == nullptr) {
+        throw_error(vas.location, SEMANTIC, "Variable '" + std::string(Interner::get_name(vas.name)) + "' does not exist\n");
+    }
+    if (TypeContext::get_info(variable->type).is_const) {
+        throw_error(vas.location, SEMANTIC, "Variable '" + std::string(Interner::get_name(vas.name)) + "' is constant\n");
+    }
+    vas.variable_id = variable->id;
     analyze_expr(*vas.expr);
+    convert(*vas.expr, variable->type, vas.location);
 }
 
 void SemanticAnalyzer::analyze_if_stmt(IfStmt& is) {
     if (is.condition == nullptr) {
-        throw_error(is.first_token.file_name, SEMANTIC, "Conditional expression must not be null\n", is.first_token.line);
+        throw_error(is.location, SEMANTIC, "Conditional expression must not be null\n");
     }
+    analyze_condition(*is.condition);
 
+    // every block is a scope of its own, `CodeGenerator` ends the lifetimes of its locals when leaving it
+    variables.push_scope();
     for (const StmtPtr& stmt : is.true_block) {
         analyze_stmt(*stmt);
     }
+    variables.pop_scope();
+    variables.push_scope();
     for (const StmtPtr& stmt : is.false_block) {
         analyze_stmt(*stmt);
     }
+    variables.pop_scope();
 }
 
 void SemanticAnalyzer::analyze_for_cycle_stmt(ForCycleStmt& fcs) {
+    // the indexator belongs to the enclosing block and stays visible after the loop, only the body gets a scope
     analyze_stmt(*fcs.indexator);
-    analyze_expr(*fcs.condition);
+    analyze_condition(*fcs.condition);
     analyze_stmt(*fcs.iteration);
     loops_blocks_deep++;
+    variables.push_scope();
 
     for (const StmtPtr& stmt : fcs.block) {
         analyze_stmt(*stmt);
     }
 
+    variables.pop_scope();
     loops_blocks_deep--;
 }
 
 void SemanticAnalyzer::analyze_while_cycle_stmt(WhileCycleStmt& wcs) {
-    analyze_expr(*wcs.condition);
+    analyze_condition(*wcs.condition);
     loops_blocks_deep++;
+    variables.push_scope();
 
     for (const StmtPtr& stmt : wcs.block) {
         analyze_stmt(*stmt);
     }
 
+    variables.pop_scope();
     loops_blocks_deep--;
 }
 
 void SemanticAnalyzer::analyze_do_while_cycle_stmt(DoWhileCycleStmt& dwcs) {
-    analyze_expr(*dwcs.condition);
+    analyze_condition(*dwcs.condition);
     loops_blocks_deep++;
+    variables.push_scope();
 
     for (const StmtPtr& stmt : dwcs.block) {
         analyze_stmt(*stmt);
     }
 
+    variables.pop_scope();
     loops_blocks_deep--;
 }
 
 void SemanticAnalyzer::analyze_break_stmt(BreakStmt& bs) {
     if (loops_blocks_deep == 0) {
-        throw_error(bs.first_token.file_name, SEMANTIC, "`break` statement must be must be inside the loop\n", bs.first_token.line);
+        throw_error(bs.location, SEMANTIC, "`break` statement must be must be inside the loop\n");
     }
 }
 
 void SemanticAnalyzer::analyze_continue_stmt(ContinueStmt& cs) {
     if (loops_blocks_deep == 0) {
-        throw_error(cs.first_token.file_name, SEMANTIC, "`continue` statement must be must be inside the loop\n", cs.first_token.line);
+        throw_error(cs.location, SEMANTIC, "`continue` statement must be must be inside the loop\n");
     }
 }
 
 void SemanticAnalyzer::analyze_return_stmt(ReturnStmt& rs) {
     if (functions_types_stack.empty()) {
-        throw_error(rs.first_token.file_name, SEMANTIC, "`return` statement must be must be inside the functions\n", rs.first_token.line);
+        throw_error(rs.location, SEMANTIC, "`return` statement must be must be inside the functions\n");
+    }
+    if (rs.expr != nullptr) {
+        analyze_expr(*rs.expr);
+        convert(*rs.expr, functions_types_stack.top(), rs.location);
     }
-    get_common_type(analyze_expr(*rs.expr), functions_types_stack.top(), rs.first_token);
 }
 
-Type SemanticAnalyzer::analyze_expr(const Expr& expr) {
-    if (auto lit = dynamic_cast<const Literal*>(&expr)) {
-        return analyze_literal(*lit);
-    }
-    else if (auto be = dynamic_cast<const BinaryExpr*>(&expr)) {
-        return analyze_binary_expr(*be);
-    }
-    else if (auto ue = dynamic_cast<const UnaryExpr*>(&expr)) {
-        return analyze_unary_expr(*ue);
-    }
-    else if (auto ve = dynamic_cast<const VarExpr*>(&expr)) {
-        return analyze_var_expr(*ve);
-    }
-    else if (auto fce = dynamic_cast<const FuncCallExpr*>(&expr)) {
-        return analyze_func_call_expr(*fce);
-    }
-    else {
-        throw_error(expr.first_token.file_name, SEMANTIC, "Unsupported expression\n", expr.first_token.line);
+// Post-order walk over `pending_exprs` instead of the call stack, so operator chains of any length can be analyzed. The arguments of a
+// call are walks of their own, stacked on top of the walk that reached the call
+TypeId SemanticAnalyzer::analyze_expr(Expr& root) {
+    std::size_t base = pending_exprs.size();
+    pending_exprs.push_back({ &root, false });
+    while (pending_exprs.size() > base) {
+        PendingExpr& pending = pending_exprs.back();
+        Expr& expr = *pending.expr;
+        if (!pending.operands_done) {
+            pending.operands_done = true;
+            if (expr.kind == NodeKind::BINARY_EXPR) {
+                // the left operand goes on top, so it is analyzed first
+                pending_exprs.push_back({ static_cast<BinaryExpr&>(expr).right, false });
+                pending_exprs.push_back({ static_cast<BinaryExpr&>(expr).left, false });
+                continue;
+            }
+            if (expr.kind == NodeKind::UNARY_EXPR) {
+                pending_exprs.push_back({ static_cast<UnaryExpr&>(expr).expr, false });
+                continue;
+            }
+        }
+        pending_exprs.pop_back();
+
+        TypeId type = NO_TYPE;
+        switch (expr.kind) {
+            case NodeKind::LITERAL:
+                type = analyze_literal(static_cast<Literal&>(expr));
+                break;
+            case NodeKind::BINARY_EXPR:
+                type = analyze_binary_expr(static_cast<BinaryExpr&>(expr));
+                break;
+            case NodeKind::UNARY_EXPR:
+                type = analyze_unary_expr(static_cast<UnaryExpr&>(expr));
+                break;
+            case NodeKind::VAR_EXPR:
+                type = analyze_var_expr(static_cast<VarExpr&>(expr));
+                break;
+            case NodeKind::FUNC_CALL_EXPR:
+                type = analyze_func_call_expr(static_cast<FuncCallExpr&>(expr));
+                break;
+            default:
+                throw_error(expr.location, SEMANTIC, "Unsupported expression\n");
+        }
+        expr.type = type;
+        expr.converted_type = type;
     }
+    return root.type;
 }
 
-Type SemanticAnalyzer::analyze_literal(const Literal& lit) {
+TypeId SemanticAnalyzer::analyze_literal(Literal& lit) {
     return lit.type;
 }
 
-Type SemanticAnalyzer::analyze_binary_expr(const BinaryExpr& be) {
-    Type left_type = analyze_expr(*be.left);
-    Type right_type = analyze_expr(*be.right);
-
-    return get_common_type(left_type, right_type, be.first_token);
+// Operands are already analyzed by `analyze_expr`
+TypeId SemanticAnalyzer::analyze_binary_expr(BinaryExpr& be) {
+    TypeId left_type = be.left->type;
+    TypeId right_type = be.right->type;
+
+    TypeId common_type = get_common_type(left_type, right_type, be.location);
+    switch (be.op_type) {
+        case TokenType::L_AND:
+        case TokenType::L_OR:
+            convert(*be.left, TypeContext::get_builtin(TypeValue::BOOL), be.location);
+            convert(*be.right, TypeContext::get_builtin(TypeValue::BOOL), be.location);
+            return TypeContext::get_builtin(TypeValue::BOOL);
+        case TokenType::GT:
+        case TokenType::GT_EQ:
+        case TokenType::LS:
+        case TokenType::LS_EQ:
+        case TokenType::EQ_EQ:
+        case TokenType::NOT_EQ:
+            be.left->converted_type = common_type;
+            be.right->converted_type = common_type;
+            return TypeContext::get_builtin(TypeValue::BOOL);
+        case TokenType::B_AND:
+        case TokenType::B_OR:
+        case TokenType::B_XOR:
+        case TokenType::L_SHIFT:
+        case TokenType::R_SHIFT:
+            if (TypeContext::get_info(common_type).is_float()) {
+                throw_error(be.location, SEMANTIC, "Bitwise operators require integer operands\n");
+            }
+            break;
+        default: {}
+    }
+    be.left->converted_type = common_type;
+    be.right->converted_type = common_type;
+    return common_type;
 }
 
-Type SemanticAnalyzer::analyze_unary_expr(const UnaryExpr& ue) {
-    return analyze_expr(*ue.expr);
+TypeId SemanticAnalyzer::analyze_unary_expr(UnaryExpr& ue) {
+    TypeId type = ue.expr->type;
+    if (ue.op_type == TokenType::B_NOT && TypeContext::get_info(type).is_float()) {
+        throw_error(ue.location, SEMANTIC, "Bitwise operators require integer operands\n");
+    }
+    if (ue.op_type == TokenType::L_NOT) {
+        return TypeContext::get_builtin(TypeValue::BOOL);
+    }
+    return type;
 }
 
-Type SemanticAnalyzer::analyze_var_expr(const VarExpr& ve) {
-    auto vars = variables;
-    while (!vars.empty()) {
-        auto var_it = vars.top().find(ve.name);
-        if (var_it != vars.top().end()) {
-            return var_it->second;
-        }
-        vars.pop();
+TypeId SemanticAnalyzer::analyze_var_expr(VarExpr& ve) {
+    if (VariableInfo* variable = variables.lookup(ve.name)) {
+        ve.variable_id = variable->id;
+        return variable->type;
     }
 
-    throw_error(ve.first_token.file_name, SEMANTIC, "Variable '" + ve.name + "' does not exist\n", ve.first_token.line);
+    throw_error(ve.location, SEMANTIC, "Variable '" + std::string(Interner::get_name(ve.name)) + "' does not exist\n");
+}
+
+TypeId SemanticAnalyzer::analyze_func_call_expr(FuncCallExpr& fce) {
+    return analyze_call(fce.name, fce.args, fce.function_id, fce.location);
 }
 
-Type SemanticAnalyzer::analyze_func_call_expr(const FuncCallExpr& fce) {
-    auto func_it = functions.find(fce.name);
-    if (func_it == functions.end()) {
+// Shared by call statements and call expressions: resolves the callee and records the conversions of the arguments
+TypeId SemanticAnalyzer::analyze_call(Symbol name, ArenaSpan<ExprPtr> args, std::uint32_t& function_id, SourceLocation location) {
+    for (const ExprPtr& arg : args) {
+        analyze_expr(*arg);
+    }
+    if (name == printf_symbol) {
+        function_id = PRINTF_FUNCTION_ID;
+        for (const ExprPtr& arg : args) {
+            promote_vararg(*arg);
+        }
+        return TypeContext::get_builtin(TypeValue::I32);
+    }
+
+    auto func_it = functions->find(name);
+    if (func_it == functions->end()) {
         std::string joined_args;
-        if (!fce.args.empty()) {
-            joined_args.reserve();
-            joined_args.append(type_to_string(analyze_expr(*fce.args[0])));
-            unsigned args_size = func_it->second.args.size();
+        if (!args.empty()) {
+            joined_args.append(TypeContext::to_string(args[0]->type));
+            unsigned args_size = args.size();
             for (unsigned i = 1; i < args_size; i++) {
                 joined_args.append(", ");
-                joined_args.append(type_to_string(analyze_expr(*fce.args[i])));
+                joined_args.append(TypeContext::to_string(args[i]->type));
             }
         }
-        throw_error(fce.first_token.file_name, SEMANTIC, "Function '" + fce.name + '(' + joined_args + ")' does not exist\n", fce.first_token.line);
+        // without the whole file only the functions declared so far are known
+        std::string hint = streaming ? " (in -stream mode functions have to be declared before they are called)" : "";
+        throw_error(location, SEMANTIC, "Function '" + std::string(Interner::get_name(name)) + '(' + joined_args + ")' does not exist" + hint + '\n');
+    }
+    if (args.size() != func_it->second.args.size()) {
+        throw_error(location, SEMANTIC, "Function '" + std::string(Interner::get_name(name)) + "' expects " + std::to_string(func_it->second.args.size())
+                    + " arguments, got " + std::to_string(args.size()) + '\n');
     }
 
-    unsigned args_size = fce.args.size();
+    function_id = func_it->second.id;
+    called_functions.push_back(function_id);
+    unsigned args_size = args.size();
     for (unsigned i = 0; i < args_size; i++) {
-        get_common_type(analyze_expr(*fce.args[i]), func_it->second.args[i].type, fce.first_token);
+        convert(*args[i], func_it->second.args[i].type, location);
     }
-    
     return func_it->second.return_type;
 }
 
-Type SemanticAnalyzer::get_common_type(Type left_type, Type right_type, Token first_token) {
-    if (left_type == right_type) {
-        return left_type;
-    }
+// Conditions are converted to `bool`, comparing them with zero
+void SemanticAnalyzer::analyze_condition(Expr& condition) {
+    analyze_expr(condition);
+    convert(condition, TypeContext::get_builtin(TypeValue::BOOL), condition.location);
+}
 
-    if (left_type.type <= TypeValue::F64) {
-        if (right_type.type <= TypeValue::F64) {
-            return left_type.type > right_type.type ? left_type : right_type;
-        }
-        else {
-            if (right_type.type >= TypeValue::STRING) {
-                throw_error(first_token.file_name, SEMANTIC, "There is no common type between " + type_to_string(left_type) + " and " + type_to_string(right_type) + '\n', first_token.line);
-            }
-            else {
-                return (int)left_type.type > (int)right_type.type - 6 ? left_type : right_type;
-            }
-        }
-    }
-    else {
-        if (left_type.type >= TypeValue::STRING) {
-            throw_error(first_token.file_name, SEMANTIC, "There is no common type between " + type_to_string(left_type) + " and " + type_to_string(right_type) + '\n', first_token.line);
-        }
-        else {
-            if (right_type.type <= TypeValue::F64) {
-                return (int)left_type.type - 6 >= (int)right_type.type ? left_type : right_type;
-            }
-            else {
-                if (right_type.type >= TypeValue::STRING) {
-                    throw_error(first_token.file_name, SEMANTIC, "There is no common type between " + type_to_string(left_type) + " and " + type_to_string(right_type) + '\n', first_token.line);
+// Literals and `const` globals combined by operators, and with `allows_calls` calls with such arguments. Walks an explicit stack,
+// like `analyze_expr`
+bool SemanticAnalyzer::is_constant_initializer(const Expr& root, bool allows_calls) {
+    std::vector<const Expr*> pending = { &root };
+    while (!pending.empty()) {
+        const Expr& expr = *pending.back();
+        pending.pop_back();
+        switch (expr.kind) {
+            case NodeKind::LITERAL:
+                break;
+            case NodeKind::BINARY_EXPR:
+                pending.push_back(static_cast<const BinaryExpr&>(expr).left);
+                pending.push_back(static_cast<const BinaryExpr&>(expr).right);
+                break;
+            case NodeKind::UNARY_EXPR:
+                pending.push_back(static_cast<const UnaryExpr&>(expr).expr);
+                break;
+            case NodeKind::VAR_EXPR:
+                if (!variables.lookup(static_cast<const VarExpr&>(expr).name)->is_constant) {
+                    return false;
+                }
+                break;
+            case NodeKind::FUNC_CALL_EXPR: {
+                const FuncCallExpr& fce = static_cast<const FuncCallExpr&>(expr);
+                if (!allows_calls || fce.function_id == PRINTF_FUNCTION_ID) {
+                    return false;
                 }
-                else {
-                    return left_type.type > right_type.type ? left_type : right_type;
+                for (const ExprPtr& arg : fce.args) {
+                    pending.push_back(arg);
                 }
+                break;
             }
+            default:
+                return false;
         }
     }
+    return true;
+}
+
+// Records that the value of `expr` is converted to `type` where it is used, which requires a common type of the two
+void SemanticAnalyzer::convert(Expr& expr, TypeId type, SourceLocation location) {
+    get_common_type(type, expr.type, location);
+    expr.converted_type = type;
 }
 
-std::string SemanticAnalyzer::type_to_string(Type type) {
-    std::string base;
-    switch (type.type) {
+// Variadic arguments follow the C default promotions: `f32` is passed as `f64`, integers narrower than `i32` as `i32`
+void SemanticAnalyzer::promote_vararg(Expr& expr) {
+    const TypeInfo& info = TypeContext::get_info(expr.type);
+    if (info.pointer_depth != 0) {
+        return;
+    }
+    switch (info.base) {
+        case TypeValue::F32:
+            expr.converted_type = TypeContext::get_builtin(TypeValue::F64);
+            break;
         case TypeValue::BOOL:
         case TypeValue::I8:
         case TypeValue::I16:
-        case TypeValue::I32:
-        case TypeValue::I64:
-        case TypeValue::F32:
-        case TypeValue::F64:
         case TypeValue::U8:
         case TypeValue::U16:
-        case TypeValue::U32:
-        case TypeValue::U64:
-        case TypeValue::STRING:
-        case TypeValue::NOTHING:
-            base = type.name;
-            break;
-        case TypeValue::CLASS:
-            base = "class <" + type.name + '>';
-            break;
-        case TypeValue::ENUM:
-            base = "enum <" + type.name + '>';
+            expr.converted_type = TypeContext::get_builtin(TypeValue::I32);
             break;
+        default: {}
     }
-    if (type.is_const) {
-        base = "const " + base;
+}
+
+void SemanticAnalyzer::set_streaming(bool enabled) {
+    streaming = enabled;
+}
+
+bool SemanticAnalyzer::has_function(Symbol name) const {
+    return functions->find(name) != functions->end();
+}
+
+// Removes the declarations of functions that cannot be called from `roots`, global initializers or other top-level statements, so no
+// IR is generated for them. Returns the names of the removed functions; nothing is removed if none of `roots` is declared
+std::vector<Symbol> SemanticAnalyzer::prune_unreachable_functions(const std::vector<Symbol>& roots) {
+    std::vector<bool> reachable(functions_count, false);
+    std::vector<std::uint32_t> pending(top_level_callees);
+    bool has_roots = false;
+    for (Symbol root : roots) {
+        auto func_it = functions->find(root);
+        if (func_it != functions->end()) {
+            pending.push_back(func_it->second.id);
+            has_roots = true;
+        }
     }
-    if (type.is_pointer) {
-        base += "*";
+    if (!has_roots) {
+        return {};
+    }
+    while (!pending.empty()) {
+        std::uint32_t function_id = pending.back();
+        pending.pop_back();
+        if (reachable[function_id]) {
+            continue;
+        }
+        reachable[function_id] = true;
+        pending.insert(pending.end(), callees[function_id].begin(), callees[function_id].end());
     }
-    return base;
-}
\ No newline at end of file
+
+    std::vector<Symbol> pruned;
+    std::size_t kept = 0;
+    for (StmtPtr stmt : stmts) {
+        if (stmt->kind == NodeKind::FUNC_DECL_STMT && !reachable[static_cast<FuncDeclStmt&>(*stmt).function_id]) {
+            pruned.push_back(static_cast<FuncDeclStmt&>(*stmt).name);
+            continue;
+        }
+        stmts[kept++] = stmt;
+    }
+    stmts.resize(kept);
+    return pruned;
+}
+
+TypeId SemanticAnalyzer::get_common_type(TypeId left_type, TypeId right_type, SourceLocation location) {
+    TypeId common_type = TypeContext::get_common_type(left_type, right_type);
+    if (common_type == NO_TYPE) {
+        throw_error(location, SEMANTIC, "There is no common type between " + TypeContext::to_string(left_type) + " and " + TypeContext::to_string(right_type) + '\n');
+    }
+    return common_type;
+}
@@ -0,0 +1,69 @@
+#include "../../include/source/interner.hpp"
+
+std::vector<std::uint32_t> Interner::slots(1024, 0);
+std::vector<std::string_view> Interner::names;
+std::vector<std::uint32_t> Interner::hashes;
+std::size_t Interner::references = 0;
+std::size_t Interner::referenced_bytes = 0;
+std::mutex Interner::mutex;
+
+// FNV-1a: identifiers are short, so a byte loop is cheaper than a wide hash
+static std::uint32_t hash_name(std::string_view name) {
+    std::uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+Symbol Interner::intern(std::string_view name) {
+    std::uint32_t hash = hash_name(name);
+    std::lock_guard<std::mutex> lock(mutex);
+    references++;
+    referenced_bytes += name.length();
+
+    std::uint32_t mask = slots.size() - 1;
+    std::uint32_t index = hash & mask;
+    while (slots[index] != 0) {
+        Symbol symbol = slots[index] - 1;
+        if (hashes[symbol] == hash && names[symbol] == name) {
+            return symbol;
+        }
+        index = (index + 1) & mask;
+    }
+
+    Symbol symbol = names.size();
+    names.push_back(name);
+    hashes.push_back(hash);
+    slots[index] = symbol + 1;
+    if (names.size() * 2 > slots.size()) {
+        grow();
+    }
+    return symbol;
+}
+
+void Interner::grow() {
+    slots.assign(slots.size() * 2, 0);
+    std::uint32_t mask = slots.size() - 1;
+    for (Symbol symbol = 0; symbol < names.size(); symbol++) {
+        std::uint32_t index = hashes[symbol] & mask;
+        while (slots[index] != 0) {
+            index = (index + 1) & mask;
+        }
+        slots[index] = symbol + 1;
+    }
+}
+
+std::string_view Interner::get_name(Symbol symbol) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return names[symbol];
+}
+
+InternerStats Interner::get_stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t unique_bytes = 0;
+    for (std::string_view name : names) {
+        unique_bytes += name.length();
+    }
+    return { names.size(), unique_bytes, references, referenced_bytes };
+}
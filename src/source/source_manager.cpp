@@ -0,0 +1,148 @@
+#include "../../include/source/source_manager.hpp"
+#include <algorithm>
+#include <cstring>
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+std::deque<SourceFile> SourceManager::files;
+SourceLocation SourceManager::next_base = 0;
+std::mutex SourceManager::line_starts_mutex;
+
+SourceFile::~SourceFile() {
+    #if !defined(_WIN32)
+    if (is_mapped) {
+        munmap(const_cast<char*>(data), size + SOURCE_PADDING);
+    }
+    #endif
+}
+
+std::optional<std::uint32_t> SourceManager::load_file(const std::string& path) {
+    #if defined(_WIN32)
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    std::vector<char> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::size_t size = buffer.size();
+    std::optional<SourceLocation> base = reserve_locations(size);
+    if (!base) {
+        return std::nullopt;
+    }
+    buffer.resize(size + SOURCE_PADDING, '\0');
+    files.emplace_back(path, std::move(buffer), size, *base);
+    return files.size() - 1;
+    #else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        // the file is mapped over zeroed anonymous memory reserved with the padding: the kernel zero-fills the tail of the last file
+        // page and the anonymous pages after it stay zero, so the padding is there even when the size is a multiple of the page size
+        std::size_t size = st.st_size;
+        void* reserved = mmap(nullptr, size + SOURCE_PADDING, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (reserved != MAP_FAILED) {
+            void* mapping = mmap(reserved, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+            if (mapping != MAP_FAILED) {
+                close(fd);
+                std::optional<SourceLocation> base = reserve_locations(size);
+                if (!base) {
+                    munmap(mapping, size + SOURCE_PADDING);
+                    return std::nullopt;
+                }
+                files.emplace_back(path, static_cast<const char*>(mapping), size, *base);
+                return files.size() - 1;
+            }
+            munmap(reserved, size + SOURCE_PADDING);
+        }
+    }
+
+    std::vector<char> buffer;
+    std::size_t size = 0;
+    while (true) {
+        buffer.resize(size + 65536);
+        ssize_t read_count = read(fd, buffer.data() + size, 65536);
+        if (read_count < 0) {
+            close(fd);
+            return std::nullopt;
+        }
+        if (read_count == 0) {
+            break;
+        }
+        size += read_count;
+    }
+    close(fd);
+    std::optional<SourceLocation> base = reserve_locations(size);
+    if (!base) {
+        return std::nullopt;
+    }
+    buffer.resize(size + SOURCE_PADDING);
+    std::fill(buffer.begin() + size, buffer.end(), '\0');
+    files.emplace_back(path, std::move(buffer), size, *base);
+    return files.size() - 1;
+    #endif
+}
+
+std::optional<std::uint32_t> SourceManager::find_file(const std::string& path) {
+    unsigned files_size = files.size();
+    for (unsigned i = 0; i < files_size; i++) {
+        if (files[i].path == path) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+const std::string& SourceManager::get_path(std::uint32_t file_id) {
+    return files[file_id].path;
+}
+
+std::string_view SourceManager::get_content(std::uint32_t file_id) {
+    return std::string_view(files[file_id].data, files[file_id].size);
+}
+
+SourceLocation SourceManager::get_base(std::uint32_t file_id) {
+    return files[file_id].base;
+}
+
+ResolvedLocation SourceManager::resolve(SourceLocation location) {
+    // files are added with increasing bases, so the owner is the last file starting at or before `location`
+    auto file_it = std::upper_bound(files.begin(), files.end(), location, [](SourceLocation loc, const SourceFile& file) {
+        return loc < file.base;
+    });
+    std::uint32_t file_id = std::distance(files.begin(), file_it) - 1;
+    SourceFile& file = files[file_id];
+
+    std::lock_guard<std::mutex> lock(line_starts_mutex);
+    if (file.line_starts.empty()) {
+        file.line_starts.push_back(0);
+        const char* begin = file.data;
+        const char* end = file.data + file.size;
+        while (const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin))) {
+            file.line_starts.push_back(newline + 1 - file.data);
+            begin = newline + 1;
+        }
+    }
+    std::uint32_t offset = location - file.base;
+    auto line_it = std::upper_bound(file.line_starts.begin(), file.line_starts.end(), offset) - 1;
+    unsigned line = std::distance(file.line_starts.begin(), line_it) + 1;
+    return ResolvedLocation{ file_id, line, offset - *line_it + 1 };
+}
+
+// One extra location per file addresses its end, e.g. for "unexpected end of file" diagnostics
+std::optional<SourceLocation> SourceManager::reserve_locations(std::size_t size) {
+    if (size >= UINT32_MAX - next_base) {
+        return std::nullopt;
+    }
+    SourceLocation base = next_base;
+    next_base += size + 1;
+    return base;
+}
@@ -0,0 +1,111 @@
+#include "../../include/types/type_context.hpp"
+
+// Which operand's type wins when two different types meet in a binary operation or a conversion
+enum class Promotion : std::uint8_t {
+    LEFT, RIGHT, NONE
+};
+
+// Bool and signed types rank by size and floats above them, unsigned types rank with the signed type of the same size.
+// `STRING`, `NOTHING`, `CLASS` and `ENUM` only have a common type with themselves
+static constexpr Promotion get_promotion(int left, int right) {
+    constexpr int F64 = static_cast<int>(TypeValue::F64);
+    constexpr int U8 = static_cast<int>(TypeValue::U8);
+    constexpr int STRING = static_cast<int>(TypeValue::STRING);
+    constexpr int UNSIGNED_OFFSET = U8 - static_cast<int>(TypeValue::I8);
+
+    if (left >= STRING || right >= STRING) {
+        return Promotion::NONE;
+    }
+    if (left <= F64 && right <= F64) {
+        return left > right ? Promotion::LEFT : Promotion::RIGHT;
+    }
+    if (left <= F64) {
+        return left > right - UNSIGNED_OFFSET ? Promotion::LEFT : Promotion::RIGHT;
+    }
+    if (right <= F64) {
+        return left - UNSIGNED_OFFSET >= right ? Promotion::LEFT : Promotion::RIGHT;
+    }
+    return left > right ? Promotion::LEFT : Promotion::RIGHT;
+}
+
+struct PromotionTable {
+    Promotion sides[TYPE_VALUES_COUNT][TYPE_VALUES_COUNT];
+
+    constexpr PromotionTable() : sides{} {
+        for (std::size_t left = 0; left < TYPE_VALUES_COUNT; left++) {
+            for (std::size_t right = 0; right < TYPE_VALUES_COUNT; right++) {
+                sides[left][right] = get_promotion(left, right);
+            }
+        }
+    }
+};
+
+static constexpr PromotionTable PROMOTION_TABLE;
+
+static constexpr const char* BUILTIN_TYPE_NAMES[TYPE_VALUES_COUNT] = {
+    "bool", "i8", "i16", "i32", "i64", "f32", "f64", "u8", "u16", "u32", "u64", "string", "nothing", "class", "enum"
+};
+
+static std::uint64_t get_type_key(TypeValue base, bool is_const, unsigned pointer_depth, Symbol name) {
+    return static_cast<std::uint64_t>(base) | static_cast<std::uint64_t>(is_const) << 8 | static_cast<std::uint64_t>(pointer_depth & 0xFF) << 16
+         | static_cast<std::uint64_t>(name) << 32;
+}
+
+std::deque<TypeInfo> TypeContext::types = [] {
+    std::deque<TypeInfo> builtin_types;
+    for (std::size_t base = 0; base < TYPE_VALUES_COUNT; base++) {
+        builtin_types.push_back({ static_cast<TypeValue>(base), false, 0, 0 });
+    }
+    return builtin_types;
+}();
+std::unordered_map<std::uint64_t, TypeId> TypeContext::ids = [] {
+    std::unordered_map<std::uint64_t, TypeId> builtin_ids;
+    for (std::size_t base = 0; base < TYPE_VALUES_COUNT; base++) {
+        builtin_ids.emplace(get_type_key(static_cast<TypeValue>(base), false, 0, 0), base);
+    }
+    return builtin_ids;
+}();
+std::mutex TypeContext::mutex;
+
+TypeId TypeContext::get(TypeValue base, bool is_const, unsigned pointer_depth, Symbol name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto [id_it, inserted] = ids.try_emplace(get_type_key(base, is_const, pointer_depth, name), types.size());
+    if (inserted) {
+        types.push_back({ base, is_const, static_cast<std::uint8_t>(pointer_depth), name });
+    }
+    return id_it->second;
+}
+
+const TypeInfo& TypeContext::get_info(TypeId type) {
+    return types[type];
+}
+
+TypeId TypeContext::get_common_type(TypeId left, TypeId right) {
+    if (left == right) {
+        return left;
+    }
+    switch (PROMOTION_TABLE.sides[static_cast<std::size_t>(types[left].base)][static_cast<std::size_t>(types[right].base)]) {
+        case Promotion::LEFT:
+            return left;
+        case Promotion::RIGHT:
+            return right;
+        default:
+            return NO_TYPE;
+    }
+}
+
+std::string TypeContext::to_string(TypeId type) {
+    const TypeInfo& info = types[type];
+    std::string result;
+    if (info.base == TypeValue::CLASS || info.base == TypeValue::ENUM) {
+        result = std::string(BUILTIN_TYPE_NAMES[static_cast<std::size_t>(info.base)]) + " <" + std::string(Interner::get_name(info.name)) + '>';
+    }
+    else {
+        result = BUILTIN_TYPE_NAMES[static_cast<std::size_t>(info.base)];
+    }
+    if (info.is_const) {
+        result = "const " + result;
+    }
+    result.append(info.pointer_depth, '*');
+    return result;
+}
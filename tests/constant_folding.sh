@@ -0,0 +1,38 @@
+#!/bin/sh
+# Compiles a program with and without constant folding: `-fold-stats` must report the expected counts and both builds must print the same
+# Use: constant_folding.sh <blinkc> <source_name> <expected_stats>
+blinkc=$1
+source_name=$2
+expected_stats=$3
+
+# `blinkc` puts the executable next to the source, so each build compiles its own copy
+work_dir=$(mktemp -d)
+trap 'rm -rf "$work_dir"' EXIT
+mkdir "$work_dir/folded" "$work_dir/unfolded"
+cp "$source_name" "$work_dir/folded/program.bl"
+cp "$source_name" "$work_dir/unfolded/program.bl"
+
+if ! "$blinkc" -fold-stats "$work_dir/folded/program.bl" > "$work_dir/folded.log" 2>&1; then
+    cat "$work_dir/folded.log"
+    echo "FAIL: $source_name does not compile"
+    exit 1
+fi
+stats=$(grep '^Constant folding: ' "$work_dir/folded.log")
+if [ "$stats" != "Constant folding: $expected_stats" ]; then
+    echo "FAIL: -fold-stats reports '$stats' instead of 'Constant folding: $expected_stats'"
+    exit 1
+fi
+if ! "$blinkc" -no-fold -fold-stats "$work_dir/unfolded/program.bl" > "$work_dir/unfolded.log" 2>&1; then
+    cat "$work_dir/unfolded.log"
+    echo "FAIL: $source_name does not compile with -no-fold"
+    exit 1
+fi
+echo "$(grep '^Constant folding: ' "$work_dir/unfolded.log") with -no-fold"
+
+folded_output=$("$work_dir/folded/program") || { echo "FAIL: the folded program exits with an error"; exit 1; }
+unfolded_output=$("$work_dir/unfolded/program") || { echo "FAIL: the unfolded program exits with an error"; exit 1; }
+if [ "$folded_output" != "$unfolded_output" ]; then
+    echo "FAIL: the folded program prints '$folded_output' instead of '$unfolded_output'"
+    exit 1
+fi
+echo "$stats, same output as without folding"
@@ -0,0 +1,95 @@
+#include "../include/source/source_manager.hpp"
+#include "../include/optimizer/optimizer.hpp"
+#include "../include/semantic/semantic.hpp"
+#include "../include/codegen/codegen.hpp"
+#include "../include/parser/parser.hpp"
+#include "../include/lexer/lexer.hpp"
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Verifier.h>
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <string>
+
+// Every pass after the lexer walks expressions with an explicit stack, so operator chains are only limited by memory: a program with
+// 100k-term chains of every kind of operator has to get through the parser, the semantic analysis, the folder (with a comptime call
+// of a function returning such a chain) and the code generator, with and without direct SSA, on the default 8 MB stack
+
+static constexpr int TERMS_COUNT = 100000;
+
+static std::string chain(const std::string& term, const std::string& op) {
+    std::string text = term;
+    for (int i = 1; i < TERMS_COUNT; i++) {
+        text += " " + op + " " + term;
+    }
+    return text;
+}
+
+static std::string generate_program() {
+    return "const ONES: i32 = " + chain("1", "+") + ";\n"
+           "func sum(x: i32) : i32 {\n"
+           "    return " + chain("x", "+") + ";\n"
+           "}\n"
+           "const SUM: i32 = sum(1);\n"
+           "func main() : i32 {\n"
+           "    var a: i32 = 1;\n"
+           "    var x: i32 = " + chain("a", "+") + ";\n"
+           "    var y: i32 = " + chain("-a", "*") + ";\n"
+           "    var all: bool = " + chain("(a > 0)", "&&") + ";\n"
+           "    var any: bool = " + chain("(a < 0)", "||") + ";\n"
+           "    if (" + chain("(x > 0)", "&&") + " || " + chain("(y < 0)", "||") + ") {\n"
+           "        x = x - 1;\n"
+           "    }\n"
+           "    if (all && !any) {\n"
+           "        printf(\"%d %d %d %d\\n\", x, y, ONES, SUM);\n"
+           "    }\n"
+           "    return 0;\n"
+           "}\n";
+}
+
+static bool check_constant(const llvm::Module& module, const char* name) {
+    const llvm::GlobalVariable* global = module.getNamedGlobal(name);
+    const llvm::ConstantInt* value = global != nullptr ? llvm::dyn_cast<llvm::ConstantInt>(global->getInitializer()) : nullptr;
+    if (value == nullptr || value->getSExtValue() != TERMS_COUNT) {
+        std::cerr << name << " is not folded to " << TERMS_COUNT << '\n';
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "blink_deep_expr.bl";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << generate_program();
+    }
+    std::optional<std::uint32_t> file_id = SourceManager::load_file(path.string());
+    std::filesystem::remove(path);
+
+    for (bool direct_ssa : { false, true }) {
+        Lexer lexer(*file_id);
+        Arena arena;
+        Parser parser(lexer.tokenize(), arena);
+        std::vector<StmtPtr> stmts = parser.parse();
+        SemanticAnalyzer semantic(stmts);
+        semantic.analyze();
+        ConstantFolder folder(arena);
+        folder.fold(stmts);
+        CodeGenerator codegen(path.string(), stmts);
+        codegen.set_direct_ssa(direct_ssa);
+        codegen.generate();
+
+        std::unique_ptr<llvm::Module> module = codegen.get_module();
+        if (llvm::verifyModule(*module, &llvm::errs())) {
+            std::cerr << "invalid module with direct SSA " << (direct_ssa ? "on" : "off") << '\n';
+            return 1;
+        }
+        if (!check_constant(*module, "ONES") || !check_constant(*module, "SUM")) {
+            return 1;
+        }
+        std::cout << TERMS_COUNT << "-term expressions compiled with direct SSA " << (direct_ssa ? "on" : "off") << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "../include/source/source_manager.hpp"
+#include "../include/exception/exception.hpp"
+#include "../include/lexer/scanner.hpp"
+#include "../include/lexer/lexer.hpp"
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Token streams of small sources, with comments, identifiers and literals placed across the 16 and 32 byte blocks of the SIMD scanners.
+// CTest runs it once per scanner version (`BLINK_SCANNER`)
+
+static int failures_count = 0;
+
+// Identifiers stand for themselves, every other token for its type
+static std::vector<std::string> lex(const std::string& text) {
+    static int sources_count = 0;
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("blink_lexer_test_" + std::to_string(sources_count++) + ".bl");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << text;
+    }
+    std::optional<std::uint32_t> file_id = SourceManager::load_file(path.string());
+    std::filesystem::remove(path);
+    std::vector<std::string> result;
+    DeferredErrorsScope deferred_errors;
+    try {
+        Lexer lexer(*file_id);
+        for (const Token& token : lexer.tokenize()) {
+            result.push_back(token.type == TokenType::ID ? std::string(token.value) : '#' + std::to_string(static_cast<int>(token.type)));
+        }
+    }
+    catch (CompileError& error) {
+        result.push_back("error: " + error.message);
+    }
+    return result;
+}
+
+static void expect_same(const std::string& name, const std::string& text, const std::string& expected_text) {
+    std::vector<std::string> tokens = lex(text);
+    std::vector<std::string> expected = lex(expected_text);
+    if (tokens != expected) {
+        std::cerr << "FAIL " << name << ": '" << text << "' lexes differently from '" << expected_text << "'\n";
+        failures_count++;
+    }
+}
+
+static void expect_error(const std::string& name, const std::string& text) {
+    std::vector<std::string> tokens = lex(text);
+    if (tokens.empty() || tokens.back().rfind("error: ", 0) != 0) {
+        std::cerr << "FAIL " << name << ": '" << text << "' lexes without an error\n";
+        failures_count++;
+    }
+}
+
+int main() {
+    expect_same("comment starting with '/'", "var a: i32 = 1; /*/ var b: i32 = 2; */ var c: i32 = 3;", "var a: i32 = 1; var c: i32 = 3;");
+    expect_same("empty comment", "a /**/ b", "a b");
+    expect_same("stars in comment", "a /* ** / * **/ b", "a b");
+    expect_same("comment at end", "a /* b */", "a");
+    expect_same("line comment", "a // b /* c\nd", "a d");
+    expect_error("unterminated comment", "a /* b");
+    expect_error("unterminated comment starting with '/'", "a /*/");
+
+    for (int length = 0; length < 80; length++) {
+        std::string filler(length, 'x');
+        expect_same("comment of " + std::to_string(length), "a /*" + filler + "*/ b", "a b");
+        expect_same("multiline comment of " + std::to_string(length), "a /*\n" + filler + "\n*/ b", "a b");
+        expect_same("identifier of " + std::to_string(length), "a " + filler + "_y9 = b", "a " + filler + "_y9 = b");
+        expect_same("string of " + std::to_string(length), "a = \"" + filler + "\\\"\"; b", "a = \"\"; b");
+        expect_same("spaces of " + std::to_string(length), "a" + std::string(length, ' ') + "\n\nb", "a b");
+    }
+
+    if (failures_count != 0) {
+        std::cerr << failures_count << " lexer checks failed (" << get_scanner_isa_name() << " scanner)\n";
+        return 1;
+    }
+    std::cout << "lexer checks passed (" << get_scanner_isa_name() << " scanner)\n";
+    return 0;
+}
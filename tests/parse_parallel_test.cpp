@@ -0,0 +1,104 @@
+#include "../include/source/source_manager.hpp"
+#include "../include/exception/exception.hpp"
+#include "../include/parser/parser.hpp"
+#include "../include/lexer/lexer.hpp"
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// `parse_parallel` has to report exactly what a serial parse reports: sources of about 30 chunks of `PARALLEL_CHUNK_TOKENS` tokens, with
+// syntax errors in one or several chunks (also ones that break the top-level boundaries), are parsed with 1 and 8 threads, and the two
+// must fail with the same first error or produce the same statements
+
+static constexpr int FUNCTIONS_COUNT = 2000;
+
+// `errors` maps the functions that get a syntax error to the kind of the error
+static std::string generate_source(const std::vector<std::pair<int, int>>& errors) {
+    std::string text;
+    for (int i = 0; i < FUNCTIONS_COUNT; i++) {
+        int error_kind = -1;
+        for (auto [function, kind] : errors) {
+            if (function == i) {
+                error_kind = kind;
+            }
+        }
+        std::string index = std::to_string(i);
+        text += "var global_" + index + ": i32 = " + index + ";\n";
+        text += "func function_" + index + "(x: i32) : i32 {\n";
+        text += error_kind == 0 ? "    var y: i32 = x + ;\n" : "    var y: i32 = x + global_" + index + ";\n";
+        text += error_kind == 1 ? "    if (y > 10 {\n" : "    if (y > 10) {\n";
+        text += "        y = y * 2;\n";
+        text += "    }\n";
+        // a missing `}` makes the following declarations look nested to the boundary pre-scan
+        text += error_kind == 2 ? "    return y;\n" : "    return y;\n}\n";
+    }
+    text += "func main() : i32 {\n    return function_0(1);\n}\n";
+    return text;
+}
+
+struct ParseResult {
+    bool failed;
+    ResolvedLocation location;
+    std::string message;
+    std::vector<NodeKind> kinds;
+};
+
+static ParseResult parse(std::uint32_t file_id, unsigned threads_count) {
+    DeferredErrorsScope deferred_errors;
+    ParseResult result{};
+    Lexer lexer(file_id);
+    Arena arena;
+    Parser parser(lexer.tokenize(), arena);
+    try {
+        for (StmtPtr stmt : parser.parse_parallel(threads_count)) {
+            result.kinds.push_back(stmt->kind);
+        }
+    }
+    catch (const CompileError& error) {
+        result.failed = true;
+        result.location = SourceManager::resolve(error.location);
+        result.message = error.message;
+    }
+    return result;
+}
+
+static bool check(const std::string& name, const std::vector<std::pair<int, int>>& errors) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("blink_parse_parallel_" + name + ".bl");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << generate_source(errors);
+    }
+    std::optional<std::uint32_t> file_id = SourceManager::load_file(path.string());
+    std::filesystem::remove(path);
+
+    ParseResult serial = parse(*file_id, 1);
+    ParseResult parallel = parse(*file_id, 8);
+    if (serial.failed != parallel.failed || serial.message != parallel.message || serial.location.line != parallel.location.line
+        || serial.location.column != parallel.location.column || serial.kinds != parallel.kinds) {
+        std::cerr << name << ": -j1 " << (serial.failed ? "fails at " + std::to_string(serial.location.line) + ':'
+                                           + std::to_string(serial.location.column) + ": " + serial.message : "succeeds\n")
+                  << name << ": -j8 " << (parallel.failed ? "fails at " + std::to_string(parallel.location.line) + ':'
+                                           + std::to_string(parallel.location.column) + ": " + parallel.message : "succeeds\n");
+        return false;
+    }
+    if (serial.failed != !errors.empty()) {
+        std::cerr << name << ": the errors are not " << (errors.empty() ? "absent" : "reported") << '\n';
+        return false;
+    }
+    std::cout << name << ": " << (serial.failed ? "same first error at line " + std::to_string(serial.location.line)
+                                                : "same " + std::to_string(serial.kinds.size()) + " statements") << '\n';
+    return true;
+}
+
+int main() {
+    bool passed = check("valid", {});
+    passed &= check("first_chunk", { { 3, 0 } });
+    passed &= check("middle_chunk", { { 1000, 1 } });
+    passed &= check("last_chunk", { { FUNCTIONS_COUNT - 1, 0 } });
+    passed &= check("several_chunks", { { 400, 1 }, { 900, 0 }, { 1700, 1 } });
+    passed &= check("two_later_chunks", { { 1500, 0 }, { 1600, 1 } });
+    passed &= check("missing_brace", { { 700, 2 }, { 1200, 0 } });
+    return passed ? 0 : 1;
+}
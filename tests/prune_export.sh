@@ -0,0 +1,51 @@
+#!/bin/sh
+# Compiles `prune.bl` with `-prune-report`: without `-export=` the unreachable `unused_a` and `unused_b` must both be pruned, with
+# `-export=unused_a` both must be kept, and exporting a function that does not exist must fail
+# Use: prune_export.sh <blinkc> <source_name>
+blinkc=$1
+source_name=$2
+
+work_dir=$(mktemp -d)
+trap 'rm -rf "$work_dir"' EXIT
+cp "$source_name" "$work_dir/program.bl"
+
+if ! "$blinkc" -prune-report "$work_dir/program.bl" > "$work_dir/pruned.log" 2>&1; then
+    cat "$work_dir/pruned.log" \
+    echo "FAIL: $source_name does not compile"
+    exit 1
+fi
+if ! grep -q '^Pruned 2 unreachable functions$' "$work_dir/pruned.log" || ! grep -q '^  unused_a$' "$work_dir/pruned.log" \
+   || ! grep -q '^  unused_b$' "$work_dir/pruned.log"; then
+    grep -A2 '^Pruned ' "$work_dir/pruned.log"
+    echo "FAIL: unused_a and unused_b are not both pruned"
+    exit 1
+fi
+if grep -q '^define .*@unused_' "$work_dir/pruned.log"; then
+    echo "FAIL: a pruned function is still generated"
+    exit 1
+fi
+echo "unused_a and unused_b pruned"
+
+if ! "$blinkc" -export=unused_a -prune-report "$work_dir/program.bl" > "$work_dir/exported.log" 2>&1; then
+    cat "$work_dir/exported.log" \
+    echo "FAIL: $source_name does not compile with -export=unused_a"
+    exit 1
+fi
+if ! grep -q '^Pruned 0 unreachable functions$' "$work_dir/exported.log" || ! grep -q '^define .*@unused_a(' "$work_dir/exported.log" \
+   || ! grep -q '^define .*@unused_b(' "$work_dir/exported.log"; then
+    grep -A2 '^Pruned ' "$work_dir/exported.log"
+    echo "FAIL: -export=unused_a does not keep unused_a and unused_b"
+    exit 1
+fi
+echo "unused_a and unused_b kept with -export=unused_a"
+
+if "$blinkc" -export=nope "$work_dir/program.bl" > "$work_dir/unknown.log" 2>&1; then
+    echo "FAIL: -export=nope compiles"
+    exit 1
+fi
+if ! grep -q "^Exported function 'nope' does not exist$" "$work_dir/unknown.log"; then
+    cat "$work_dir/unknown.log"
+    echo "FAIL: -export=nope fails without saying the function does not exist"
+    exit 1
+fi
+echo "-export=nope rejected"
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Compiles a program with `blinkc` at each of the given optimization levels and runs it on a 256 KB stack; its output must match
+# Use: stack_usage.sh <blinkc> <source_name> <expected_output> <-O level>...
+blinkc=$1
+source_name=$2
+expected_output=$3
+shift 3
+
+# `blinkc` puts the executable next to the source, so the program is compiled from a copy
+work_dir=$(mktemp -d)
+trap 'rm -rf "$work_dir"' EXIT
+cp "$source_name" "$work_dir/program.bl"
+
+for level in "$@"; do
+    if ! "$blinkc" "$level" "$work_dir/program.bl" > "$work_dir/blinkc.log" 2>&1; then
+        cat "$work_dir/blinkc.log"
+        echo "FAIL $level: $source_name does not compile"
+        exit 1
+    fi
+    if ! output=$(ulimit -s 256 && "$work_dir/program"); then
+        echo "FAIL $level: $source_name exits with an error on a 256 KB stack"
+        exit 1
+    fi
+    if [ "$output" != "$expected_output" ]; then
+        echo "FAIL $level: $source_name prints '$output' instead of '$expected_output'"
+        exit 1
+    fi
+    echo "$level: '$output' on a 256 KB stack"
+done
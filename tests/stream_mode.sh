@@ -0,0 +1,52 @@
+#!/bin/sh
+# Compiles every example with and without `-stream`; both modes must print the same IR and exit with the same status. The batch build
+# exports every function, as `-stream` does not prune unreachable ones. Then checks the diagnostics of what `-stream` does not support
+# Use: stream_mode.sh <blinkc> <examples_dir>
+blinkc=$1
+examples_dir=$2
+
+# `blinkc` puts the executable next to the source, so everything is compiled from copies
+work_dir=$(mktemp -d)
+trap 'rm -rf "$work_dir"' EXIT
+cp -r "$examples_dir"/. "$work_dir"
+
+# IR and the exit status of a build, without the progress messages
+compile() {
+    { "$blinkc" "$@"; echo "exit status $?"; } 2> /dev/null | grep -v -e '^CODE' -e '^COMPILING'
+}
+
+status=0
+for source_name in "$work_dir"/*.bl; do
+    functions=$(sed -n 's/^ *func \([A-Za-z_][A-Za-z0-9_]*\).*/\1/p' "$source_name" | grep -v '^main$' | paste -s -d, -)
+    compile ${functions:+-export=$functions} "$source_name" > "$work_dir/batch.ll"
+    compile -stream "$source_name" > "$work_dir/stream.ll"
+    if cmp -s "$work_dir/batch.ll" "$work_dir/stream.ll"; then
+        echo "$(basename "$source_name"): same IR"
+    else
+        diff "$work_dir/batch.ll" "$work_dir/stream.ll" | head -20
+        echo "FAIL $(basename "$source_name"): -stream generates different IR"
+        status=1
+    fi
+done
+
+# expects `-stream` to reject the program with a diagnostic containing the given text, which batch mode compiles
+check_unsupported() {
+    printf '%s\n' "$1" > "$work_dir/unsupported.bl"
+    if ! "$blinkc" "$work_dir/unsupported.bl" > /dev/null 2>&1; then
+        echo "FAIL batch mode does not compile: $1"
+        status=1
+    fi
+    if output=$("$blinkc" -stream "$work_dir/unsupported.bl" 2>&1) || ! echo "$output" | grep -q -e "$2"; then
+        echo "$output"
+        echo "FAIL -stream does not report '$2' for: $1"
+        status=1
+    else
+        echo "-stream reports '$2'"
+    fi
+}
+
+check_unsupported 'func main() : i32 { return later(1); } func later(x: i32) : i32 { return x; }' \
+                  'functions have to be declared before they are called'
+check_unsupported 'func fib(n: i32) : i32 { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); } const F10: i32 = fib(10); func main() : i32 { return F10; }' \
+                  'does not keep function bodies'
+exit $status
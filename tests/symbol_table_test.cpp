@@ -0,0 +1,68 @@
+#include "../include/source/source_manager.hpp"
+#include "../include/semantic/semantic.hpp"
+#include "../include/parser/parser.hpp"
+#include "../include/lexer/lexer.hpp"
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+
+// Name resolution must take linear time: a function with `locals_count` locals and 10 references per local is checked for 5k and 50k
+// locals, and 10x the locals has to take well under the 100x a quadratic symbol table would. It takes 25-35x rather than 10x, as the
+// 5k locals table fits in the L2 cache and the 50k one does not
+
+static std::string generate_function(int locals_count) {
+    std::string text = "func main() : i32 {\n";
+    for (int i = 0; i < locals_count; i++) {
+        text += "    var v" + std::to_string(i) + ": i32 = " + std::to_string(i % 100) + ";\n";
+    }
+    for (int i = 0; i < locals_count; i++) {
+        text += "    v" + std::to_string(i) + " = v" + std::to_string((i * 7 + 1) % locals_count);
+        for (int term = 2; term < 10; term++) {
+            text += " + v" + std::to_string((i * 31 + term * 997) % locals_count);
+        }
+        text += ";\n";
+    }
+    text += "    return v0;\n}\n";
+    return text;
+}
+
+// Best of three semantic analysis times, in seconds
+static double time_analysis(int locals_count) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / ("blink_symbols_" + std::to_string(locals_count) + ".bl");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << generate_function(locals_count);
+    }
+    std::optional<std::uint32_t> file_id = SourceManager::load_file(path.string());
+    std::filesystem::remove(path);
+
+    double best_seconds = 0;
+    for (int run = 0; run < 3; run++) {
+        Lexer lexer(*file_id);
+        Arena arena;
+        Parser parser(lexer.tokenize(), arena);
+        std::vector<StmtPtr> stmts = parser.parse();
+        SemanticAnalyzer semantic(stmts);
+        auto start = std::chrono::steady_clock::now();
+        semantic.analyze();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best_seconds = run == 0 ? seconds : std::min(best_seconds, seconds);
+    }
+    return best_seconds;
+}
+
+int main() {
+    double small_seconds = time_analysis(5000);
+    double large_seconds = time_analysis(50000);
+    double ratio = large_seconds / small_seconds;
+    std::cout << "5k locals / 50k references: " << small_seconds * 1000 << " ms, 50k locals / 500k references: " << large_seconds * 1000
+              << " ms (" << ratio << "x)\n";
+    if (ratio > 50) {
+        std::cerr << "name resolution does not scale linearly\n";
+        return 1;
+    }
+    return 0;
+}